@@ -1,5 +1,5 @@
 SET(${PACKAGE_NAME}_Trilinos_REQUIRED_COMPONENTS Belos Kokkos Intrepid2 Stratimikos Teuchos Thyra Tpetra)
-SET(${PACKAGE_NAME}_Trilinos_OPTIONAL_COMPONENTS "")
+SET(${PACKAGE_NAME}_Trilinos_OPTIONAL_COMPONENTS Amesos2)
 
 IF (${PACKAGE_NAME}_ARBORX_TPL)
   SET(ARBORX_PACKAGE "ArborX"
@@ -11,3 +11,9 @@ FIND_PACKAGE(Trilinos REQUIRED
 GLOBAL_SET(TPL_Trilinos_INCLUDE_DIRS "${Trilinos_INCLUDE_DIRS};${Trilinos_LIBRARY_DIRS}")
 GLOBAL_SET(TPL_Trilinos_LIBRARIES    "${Trilinos_LIBRARIES};${Trilinos_TPL_LIBRARIES}")
 GLOBAL_SET(TPL_Trilinos_LIBRARY_DIRS "${Trilinos_LIBRARY_DIRS};${Trilinos_TPL_LIBRARY_DIRS}")
+
+# The optional components are only enabled if Trilinos was built with them.
+LIST(FIND Trilinos_PACKAGE_LIST Amesos2 _Amesos2_INDEX)
+IF(NOT _Amesos2_INDEX EQUAL -1)
+  GLOBAL_SET(HAVE_DATATRANSFERKIT_AMESOS2 TRUE)
+ENDIF()
@@ -14,44 +14,87 @@
 
 #include <DTK_Topology.hpp>
 
+#include <Kokkos_Array.hpp>
 #include <Kokkos_Macros.hpp>
 #include <Kokkos_View.hpp>
 
+#include <cmath>
+
 namespace DataTransferKit
 {
 namespace Discretization
 {
 namespace Helpers
 {
+/**
+ * Number of cells of each topology. This is the value type of the reductions
+ * and scans over the cells of the mesh.
+ */
+struct TopologyCount
+{
+    unsigned int count[DTK_N_TOPO];
+};
+
+/**
+ * Functor that counts the number of cells of each topology.
+ */
 template <typename DeviceType>
-std::array<unsigned int, DTK_N_TOPO> computeNCellsPerTopology(
-    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view )
+class CellTopologyCounter
 {
-    // This needs to be done on the host because we will use n_cells_per_topo
-    // to allocate Kokkos::View and this needs to be done on the host
-    std::array<unsigned int, DTK_N_TOPO> n_cells_per_topo;
-    auto cell_topologies_host =
-        Kokkos::create_mirror_view( cell_topologies_view );
-    Kokkos::deep_copy( cell_topologies_host, cell_topologies_view );
-    unsigned int const n_cells = cell_topologies_view.extent( 0 );
-    // Initialize dtk_cell_topo with an invalid topology
-    DTK_CellTopology dtk_cell_topo = DTK_N_TOPO;
-    n_cells_per_topo.fill( 0 );
-    for ( unsigned int i = 0; i < n_cells; ++i )
+  public:
+    using value_type = TopologyCount;
+
+    CellTopologyCounter(
+        Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies )
+        : _cell_topologies( cell_topologies )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void init( value_type &update ) const
     {
-        dtk_cell_topo = cell_topologies_host( i );
-        n_cells_per_topo[dtk_cell_topo] += 1;
+        for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+            update.count[topo_id] = 0;
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void join( volatile value_type &update,
+               volatile value_type const &input ) const
+    {
+        for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+            update.count[topo_id] += input.count[topo_id];
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( int const i, value_type &update ) const
+    {
+        update.count[_cell_topologies( i )] += 1;
     }
 
+  private:
+    Kokkos::View<DTK_CellTopology *, DeviceType> _cell_topologies;
+};
+
+/**
+ * Check that the mesh only contains supported topologies.
+ */
+inline void checkNCellsPerTopology(
+    std::array<unsigned int, DTK_N_TOPO> const &n_cells_per_topo,
+    unsigned int const n_cells )
+{
 #if HAVE_DTK_DBC
-    Topologies topologies;
-    unsigned int dim = topologies[dtk_cell_topo].dim;
     // We do not support meshes that contain both 2D and 3D cells. All the
     // cells are either 2D or 3D
+    Topologies topologies;
+    unsigned int dim = 0;
     for ( unsigned int i = 0; i < DTK_N_TOPO; ++i )
     {
         if ( n_cells_per_topo[i] != 0 )
-            DTK_REQUIRE( topologies[dtk_cell_topo].dim == dim );
+        {
+            if ( dim == 0 )
+                dim = topologies[i].dim;
+            DTK_REQUIRE( topologies[i].dim == dim );
+        }
     }
 #endif
 
@@ -61,19 +104,41 @@ std::array<unsigned int, DTK_N_TOPO> computeNCellsPerTopology(
     DTK_REQUIRE( n_cells_per_topo[DTK_WEDGE_15] == 0 );
 
 #if HAVE_DTK_DBC
-    // The sum of the number of cells per topology should be equal to the size
-    // of cell_topologies_view
+    // The sum of the number of cells per topology should be equal to the
+    // number of cells
     unsigned int sum = 0;
     for ( unsigned int i = 0; i < DTK_N_TOPO; ++i )
     {
         sum += n_cells_per_topo[i];
     }
     DTK_REQUIRE( sum == n_cells );
+#else
+    (void)n_cells;
 #endif
+}
+
+template <typename DeviceType>
+std::array<unsigned int, DTK_N_TOPO> computeNCellsPerTopology(
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view )
+{
+    // The histogram is computed on the device and only the DTK_N_TOPO values
+    // are copied to the host, where they are used to allocate Kokkos::View.
+    using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int const n_cells = cell_topologies_view.extent( 0 );
+    TopologyCount topology_count;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "compute_n_cells_per_topo" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        CellTopologyCounter<DeviceType>( cell_topologies_view ),
+        topology_count );
+
+    std::array<unsigned int, DTK_N_TOPO> n_cells_per_topo;
+    for ( unsigned int i = 0; i < DTK_N_TOPO; ++i )
+        n_cells_per_topo[i] = topology_count.count[i];
+    checkNCellsPerTopology( n_cells_per_topo, n_cells );
 
     return n_cells_per_topo;
 }
-
 template <typename DeviceType>
 void checkOffsetOverflow( Kokkos::View<unsigned int *, DeviceType> offset )
 {
@@ -157,10 +222,10 @@ template <typename DeviceType>
 struct MeshOffsets
 {
     MeshOffsets( Mesh<DeviceType> const &mesh )
-        : n_nodes_per_topo( "n_nodes_per_topo" )
+        : node_offset( "node_offset", mesh.cell_topologies.extent( 0 ) )
+        , n_nodes_per_topo( "n_nodes_per_topo" )
     {
-        // First, we get the number of nodes for each topology to get
-        // initialize block_cells at the right size.
+        // First, we get the number of nodes for each topology.
         auto n_nodes_per_topo_host =
             Kokkos::create_mirror_view( n_nodes_per_topo );
         Topologies topologies;
@@ -168,181 +233,243 @@ struct MeshOffsets
             n_nodes_per_topo_host( i ) = topologies[i].n_nodes;
         Kokkos::deep_copy( n_nodes_per_topo, n_nodes_per_topo_host );
 
-        unsigned int const n_cells = mesh.cell_topologies.extent( 0 );
+        // Compute the number of cells of each topology. This also checks that
+        // the topologies are supported.
+        n_cells_per_topo = computeNCellsPerTopology( mesh.cell_topologies );
 
-        for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
-        {
-            offsets[topo_id] = Kokkos::View<unsigned int *, DeviceType>(
-                "offset_" + std::to_string( topo_id ), n_cells );
-            computeOffset( mesh.cell_topologies, topo_id, offsets[topo_id] );
-
-            node_offsets[topo_id] = Kokkos::View<unsigned int *, DeviceType>(
-                "node_offset", n_cells );
-            computeNodeOffset( mesh.cell_topologies, n_nodes_per_topo,
-                               node_offsets[topo_id] );
-        }
+        computeNodeOffset( mesh.cell_topologies, n_nodes_per_topo,
+                           node_offset );
     }
 
-    std::array<Kokkos::View<unsigned int *, DeviceType>, DTK_N_TOPO> offsets;
-    std::array<Kokkos::View<unsigned int *, DeviceType>, DTK_N_TOPO>
-        node_offsets;
+    /// Position of the first node of each cell in Mesh::cells (n cells)
+    Kokkos::View<unsigned int *, DeviceType> node_offset;
     Kokkos::View<unsigned int[DTK_N_TOPO], DeviceType> n_nodes_per_topo;
+    std::array<unsigned int, DTK_N_TOPO> n_cells_per_topo;
 };
 
-template <typename DeviceType>
-KOKKOS_FUNCTION void
-buildBlockCells( unsigned int const dim, int const i,
-                 unsigned int const n_nodes, unsigned int const node_offset,
-                 Kokkos::View<unsigned int *, DeviceType> cells,
-                 Kokkos::View<unsigned int *, DeviceType> offset,
-                 Kokkos::View<Coordinate **, DeviceType> coordinates,
-                 Kokkos::View<Coordinate ***, DeviceType> block_cells )
-{
-    unsigned int const k = offset( i );
-    for ( unsigned int node = 0; node < n_nodes; ++node )
-    {
-        unsigned int const n = node_offset + node;
-        for ( unsigned int d = 0; d < dim; ++d )
-        {
-            // Copy the coordinated in block_cells
-            block_cells( k, node, d ) = coordinates( cells( n ), d );
-        }
-    }
-}
-
-/**
- * Convert the 1D Kokkos View cells and coordinates to arrays of 3D Kokkos
- * Views more suitable for Intrepid2.
- */
-template <typename DeviceType>
-void convertMesh( Mesh<DeviceType> const &mesh,
-                  MeshOffsets<DeviceType> const &mesh_offsets,
-                  std::array<Kokkos::View<Coordinate ***, DeviceType>,
-                             DTK_N_TOPO> &block_cells )
-{
-    using ExecutionSpace = typename DeviceType::execution_space;
-    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
-    {
-        DTK_REQUIRE( mesh_offsets.offsets[topo_id].extent( 0 ) ==
-                     mesh.cell_topologies.extent( 0 ) );
-        DTK_REQUIRE( block_cells[topo_id].extent( 2 ) ==
-                     mesh.nodes_coordinates.extent( 1 ) );
-
-        unsigned int const dim = mesh.nodes_coordinates.extent( 1 );
-        unsigned int const n_cells = mesh.cell_topologies.extent( 0 );
-        auto block_cells_topo = block_cells[topo_id];
-        auto node_offset = mesh_offsets.node_offsets[topo_id];
-        auto offset = mesh_offsets.offsets[topo_id];
-
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "build_block_cells_" + std::to_string( topo_id ) ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
-            KOKKOS_LAMBDA( int const i ) {
-                if ( mesh.cell_topologies( i ) == topo_id )
-                {
-                    buildBlockCells( dim, i,
-                                     mesh_offsets.n_nodes_per_topo( topo_id ),
-                                     node_offset( i ), mesh.cells, offset,
-                                     mesh.nodes_coordinates, block_cells_topo );
-                }
-            } );
-        Kokkos::fence();
-    }
-}
-
 template <typename DeviceType>
 KOKKOS_FUNCTION void
 buildBoundingBoxes( unsigned int const dim, int const i,
                     unsigned int const n_nodes, unsigned int const node_offset,
                     Kokkos::View<unsigned int *, DeviceType> cells,
-                    unsigned int const offset,
                     Kokkos::View<Coordinate **, DeviceType> coordinates,
-                    Kokkos::View<Coordinate ***, DeviceType> block_cells,
                     Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes )
 {
     ArborX::Box bounding_box;
     // If dim == 2, we need to set bounding_box.minCorner()[2] and
-    // bounding_box.maxCorner[2].
+    // bounding_box.maxCorner[2]. The 2D points are in the z = 0 plane.
     if ( dim == 2 )
     {
         bounding_box.minCorner()[2] = 0;
-        bounding_box.maxCorner()[2] = 1;
+        bounding_box.maxCorner()[2] = 0;
     }
     for ( unsigned int node = 0; node < n_nodes; ++node )
     {
-        unsigned int const n = node_offset + node;
+        unsigned int const n = cells( node_offset + node );
         for ( unsigned int d = 0; d < dim; ++d )
         {
-            // Copy the coordinated in block_cells
-            block_cells( offset, node, d ) = coordinates( cells( n ), d );
             // Build the bounding box.
-            if ( block_cells( offset, node, d ) < bounding_box.minCorner()[d] )
-                bounding_box.minCorner()[d] = block_cells( offset, node, d );
-            if ( block_cells( offset, node, d ) > bounding_box.maxCorner()[d] )
-                bounding_box.maxCorner()[d] = block_cells( offset, node, d );
+            if ( coordinates( n, d ) < bounding_box.minCorner()[d] )
+                bounding_box.minCorner()[d] = coordinates( n, d );
+            if ( coordinates( n, d ) > bounding_box.maxCorner()[d] )
+                bounding_box.maxCorner()[d] = coordinates( n, d );
         }
     }
     bounding_boxes( i ) = bounding_box;
 }
 
 /**
- * Build the bounding boxes associated to the cell and the map between the
- * bounding boxes and the flat array of cells.
+ * Build the bounding boxes associated to the cells. The coordinates of the
+ * nodes are read directly through the connectivity of the mesh. All the
+ * topologies are processed by a single kernel. This function is also used to
+ * recompute the bounding boxes after the nodes of the mesh have moved.
  */
 template <typename DeviceType>
 void createBoundingBoxes(
-    Mesh<DeviceType> const &mesh, MeshOffsets<DeviceType> const &mesh_offsets,
-    std::array<Kokkos::View<Coordinate ***, DeviceType>, DTK_N_TOPO> const
-        &block_cells,
-    Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes,
-    Kokkos::View<unsigned int **, DeviceType> bounding_box_to_cell )
+    Mesh<DeviceType> const &mesh,
+    Kokkos::View<unsigned int *, DeviceType> node_offset,
+    Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes )
 {
+    DTK_REQUIRE( node_offset.extent( 0 ) == mesh.cell_topologies.extent( 0 ) );
+    DTK_REQUIRE( bounding_boxes.extent( 0 ) ==
+                 mesh.cell_topologies.extent( 0 ) );
+
     using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int const dim = mesh.nodes_coordinates.extent( 1 );
+    unsigned int const n_cells = mesh.cell_topologies.extent( 0 );
+    Kokkos::Array<unsigned int, DTK_N_TOPO> n_nodes_per_topo;
+    Topologies topologies;
     for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+        n_nodes_per_topo[topo_id] = topologies[topo_id].n_nodes;
+    auto cell_topologies = mesh.cell_topologies;
+    auto cells = mesh.cells;
+    auto coordinates = mesh.nodes_coordinates;
+
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "build_bounding_boxes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        KOKKOS_LAMBDA( int const i ) {
+            buildBoundingBoxes( dim, i, n_nodes_per_topo[cell_topologies( i )],
+                                node_offset( i ), cells, coordinates,
+                                bounding_boxes );
+        } );
+    Kokkos::fence();
+}
+
+/**
+ * Number of directions of the discrete oriented polytopes (k-DOP) built around
+ * the cells: the three axes and the six diagonals of the faces of the unit
+ * cube. A k-DOP is made of the minimum and the maximum projections of the nodes
+ * of the cell on each direction (k = 18).
+ */
+unsigned int constexpr n_kdop_directions = 9;
+
+/**
+ * Return the (unnormalized) projection of \p x on the k-DOP direction \p
+ * direction. In 2D, x[2] must be zero.
+ */
+KOKKOS_INLINE_FUNCTION
+double projectOnKDOPDirection( unsigned int const direction, double const *x )
+{
+    switch ( direction )
     {
-        DTK_REQUIRE( mesh_offsets.offsets[topo_id].extent( 0 ) ==
-                     mesh.cell_topologies.extent( 0 ) );
-        DTK_REQUIRE( mesh_offsets.node_offsets[topo_id].extent( 0 ) ==
-                     mesh.cell_topologies.extent( 0 ) );
-        DTK_REQUIRE( bounding_boxes.extent( 0 ) ==
-                     mesh.cell_topologies.extent( 0 ) );
-
-        // Build BoundingBoxes
-        unsigned int const dim = mesh.nodes_coordinates.extent( 1 );
-        unsigned int const n_cells = mesh.cell_topologies.extent( 0 );
-        auto node_offset = mesh_offsets.node_offsets[topo_id];
-        auto block_cells_topo = block_cells[topo_id];
-        auto offset = mesh_offsets.offsets[topo_id];
-
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "build_bounding_boxes_" +
-                             std::to_string( topo_id ) ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
-            KOKKOS_LAMBDA( int const i ) {
-                if ( mesh.cell_topologies( i ) == topo_id )
-                {
-                    buildBoundingBoxes(
-                        dim, i, mesh_offsets.n_nodes_per_topo( topo_id ),
-                        node_offset( i ), mesh.cells, offset( i ),
-                        mesh.nodes_coordinates, block_cells_topo,
-                        bounding_boxes );
-                }
-            } );
-        Kokkos::fence();
-
-        // Build map between BoundingBoxes and BlockCells
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "build_bounding_boxes_to_block_cells_" +
-                             std::to_string( topo_id ) ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
-            KOKKOS_LAMBDA( int const i ) {
-                if ( mesh.cell_topologies( i ) == topo_id )
+    case 0:
+        return x[0];
+    case 1:
+        return x[1];
+    case 2:
+        return x[2];
+    case 3:
+        return x[0] + x[1];
+    case 4:
+        return x[0] - x[1];
+    case 5:
+        return x[0] + x[2];
+    case 6:
+        return x[0] - x[2];
+    case 7:
+        return x[1] + x[2];
+    default:
+        return x[1] - x[2];
+    }
+}
+
+/**
+ * Build the k-DOPs associated to the cells. The minimum projections are stored
+ * in kdops(i, 0:n_kdop_directions) and the maximum projections in kdops(i,
+ * n_kdop_directions:2*n_kdop_directions). The k-DOPs are slightly enlarged so
+ * that the points that are on the boundary of a cell, and which are accepted
+ * by PointInCell, are not filtered out.
+ */
+template <typename DeviceType>
+void createKDOPs( Mesh<DeviceType> const &mesh,
+                  Kokkos::View<unsigned int *, DeviceType> node_offset,
+                  Kokkos::View<Coordinate **, DeviceType> kdops )
+{
+    DTK_REQUIRE( node_offset.extent( 0 ) == mesh.cell_topologies.extent( 0 ) );
+    DTK_REQUIRE( kdops.extent( 0 ) == mesh.cell_topologies.extent( 0 ) );
+    DTK_REQUIRE( kdops.extent( 1 ) == 2 * n_kdop_directions );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int const dim = mesh.nodes_coordinates.extent( 1 );
+    unsigned int const n_cells = mesh.cell_topologies.extent( 0 );
+    Kokkos::Array<unsigned int, DTK_N_TOPO> n_nodes_per_topo;
+    Topologies topologies;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+        n_nodes_per_topo[topo_id] = topologies[topo_id].n_nodes;
+    auto cell_topologies = mesh.cell_topologies;
+    auto cells = mesh.cells;
+    auto coordinates = mesh.nodes_coordinates;
+
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "build_kdops" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        KOKKOS_LAMBDA( int const i ) {
+            unsigned int const n_nodes =
+                n_nodes_per_topo[cell_topologies( i )];
+            for ( unsigned int node = 0; node < n_nodes; ++node )
+            {
+                unsigned int const n = cells( node_offset( i ) + node );
+                double x[3] = {0., 0., 0.};
+                for ( unsigned int d = 0; d < dim; ++d )
+                    x[d] = coordinates( n, d );
+                for ( unsigned int k = 0; k < n_kdop_directions; ++k )
                 {
-                    bounding_box_to_cell( i, topo_id ) = offset( i );
+                    double const projection = projectOnKDOPDirection( k, x );
+                    if ( ( node == 0 ) || ( projection < kdops( i, k ) ) )
+                        kdops( i, k ) = projection;
+                    if ( ( node == 0 ) ||
+                         ( projection > kdops( i, n_kdop_directions + k ) ) )
+                        kdops( i, n_kdop_directions + k ) = projection;
                 }
-            } );
-        Kokkos::fence();
-    }
+            }
+
+            // The points are sent as ArborX::Point which uses float
+            double const tol = 1e-6;
+            for ( unsigned int k = 0; k < n_kdop_directions; ++k )
+            {
+                double &min = kdops( i, k );
+                double &max = kdops( i, n_kdop_directions + k );
+                double const slack =
+                    tol * ( max - min + std::abs( min ) + std::abs( max ) );
+                min -= slack;
+                max += slack;
+            }
+        } );
+    Kokkos::fence();
+}
+
+/**
+ * Enlarge the bounding boxes by \p margin times their extent in each
+ * direction.
+ */
+template <typename DeviceType>
+void fattenBoundingBoxes(
+    unsigned int const dim, double const margin,
+    Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int const n_boxes = bounding_boxes.extent( 0 );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "fatten_bounding_boxes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_boxes ),
+        KOKKOS_LAMBDA( int const i ) {
+            auto &box = bounding_boxes( i );
+            for ( unsigned int d = 0; d < dim; ++d )
+            {
+                double const delta =
+                    margin * ( box.maxCorner()[d] - box.minCorner()[d] );
+                box.minCorner()[d] -= delta;
+                box.maxCorner()[d] += delta;
+            }
+        } );
+    Kokkos::fence();
+}
+
+/**
+ * Return the sum of the volumes (areas in 2D) of the bounding boxes.
+ */
+template <typename DeviceType>
+double computeBoundingBoxesVolume(
+    unsigned int const dim,
+    Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int const n_boxes = bounding_boxes.extent( 0 );
+    double volume = 0.;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "compute_bounding_boxes_volume" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_boxes ),
+        KOKKOS_LAMBDA( int const i, double &partial_sum ) {
+            auto const &box = bounding_boxes( i );
+            double box_volume = 1.;
+            for ( unsigned int d = 0; d < dim; ++d )
+                box_volume *= box.maxCorner()[d] - box.minCorner()[d];
+            partial_sum += box_volume;
+        },
+        volume );
+
+    return volume;
 }
 } // namespace Helpers
 } // namespace Discretization
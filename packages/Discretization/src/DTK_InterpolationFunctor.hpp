@@ -26,6 +26,7 @@ class Interpolation
     Interpolation( unsigned int const dim,
                    Kokkos::View<Coordinate **, DeviceType> reference_points,
                    Kokkos::View<LocalOrdinal **, DeviceType> cell_dofs_ids,
+                   Kokkos::View<int *, DeviceType> cells,
                    Kokkos::View<Scalar **, DeviceType> dof_values,
                    Kokkos::View<Scalar **, DeviceType> output )
         : _dim( dim )
@@ -34,6 +35,7 @@ class Interpolation
         , _basis_values( "basis_values", output.extent( 0 ), _n_basis, dim )
         , _reference_points( reference_points )
         , _cell_dofs_ids( cell_dofs_ids )
+        , _cells( cells )
         , _dof_values( dof_values )
         , _output( output )
     {
@@ -48,11 +50,13 @@ class Interpolation
             Kokkos::subview( _basis_values, i, Kokkos::ALL(), Kokkos::ALL() );
         BasisType::getValues( basis_values, ref_point );
 
+        int const cell = _cells( i );
         for ( unsigned int j = 0; j < _n_basis; ++j )
             for ( unsigned int d = 0; d < _dim; ++d )
                 for ( unsigned int k = 0; k < _n_fields; ++k )
-                    _output( i, k ) += basis_values( j, d ) *
-                                       _dof_values( _cell_dofs_ids( i, j ), k );
+                    _output( i, k ) +=
+                        basis_values( j, d ) *
+                        _dof_values( _cell_dofs_ids( cell, j ), k );
     }
 
   private:
@@ -62,6 +66,7 @@ class Interpolation
     Kokkos::DynRankView<Coordinate, DeviceType> _basis_values;
     Kokkos::View<Coordinate **, DeviceType> _reference_points;
     Kokkos::View<LocalOrdinal **, DeviceType> _cell_dofs_ids;
+    Kokkos::View<int *, DeviceType> _cells;
     Kokkos::View<Scalar **, DeviceType> _dof_values;
     Kokkos::View<Scalar **, DeviceType> _output;
 };
@@ -73,6 +78,7 @@ class HgradInterpolation
     HgradInterpolation(
         Kokkos::View<Coordinate **, DeviceType> reference_points,
         Kokkos::View<LocalOrdinal **, DeviceType> cell_dofs_ids,
+        Kokkos::View<int *, DeviceType> cells,
         Kokkos::View<Scalar **, DeviceType> dof_values,
         Kokkos::View<Scalar **, DeviceType> output )
         : _n_basis( cell_dofs_ids.extent( 1 ) )
@@ -80,6 +86,7 @@ class HgradInterpolation
         , _basis_values( "basis_values", output.extent( 0 ), _n_basis )
         , _reference_points( reference_points )
         , _cell_dofs_ids( cell_dofs_ids )
+        , _cells( cells )
         , _dof_values( dof_values )
         , _output( output )
     {
@@ -93,10 +100,11 @@ class HgradInterpolation
         auto basis_values = Kokkos::subview( _basis_values, i, Kokkos::ALL() );
         BasisType::getValues( basis_values, ref_point );
 
+        int const cell = _cells( i );
         for ( unsigned int j = 0; j < _n_basis; ++j )
             for ( unsigned int k = 0; k < _n_fields; ++k )
                 _output( i, k ) += basis_values( j ) *
-                                   _dof_values( _cell_dofs_ids( i, j ), k );
+                                   _dof_values( _cell_dofs_ids( cell, j ), k );
     }
 
   private:
@@ -107,9 +115,117 @@ class HgradInterpolation
     Kokkos::View<Coordinate **, DeviceType> _basis_values;
     Kokkos::View<Coordinate **, DeviceType> _reference_points;
     Kokkos::View<LocalOrdinal **, DeviceType> _cell_dofs_ids;
+    Kokkos::View<int *, DeviceType> _cells;
     Kokkos::View<Scalar **, DeviceType> _dof_values;
     Kokkos::View<Scalar **, DeviceType> _output;
 };
+
+/**
+ * Evaluate the basis functions at the reference points and store the values
+ * along with the associated degrees of freedom in a matrix in CRS format. Each
+ * row of the matrix has n_basis entries.
+ */
+template <typename BasisType, typename DeviceType>
+class Tabulation
+{
+  public:
+    Tabulation( unsigned int const dim,
+                Kokkos::View<Coordinate **, DeviceType> reference_points,
+                Kokkos::View<LocalOrdinal **, DeviceType> cell_dofs_ids,
+                Kokkos::View<int *, DeviceType> cells,
+                unsigned int const entry_offset,
+                Kokkos::View<LocalOrdinal *, DeviceType> columns,
+                Kokkos::View<Coordinate *, DeviceType> values )
+        : _dim( dim )
+        , _n_basis( cell_dofs_ids.extent( 1 ) )
+        , _entry_offset( entry_offset )
+        , _basis_values( "basis_values", reference_points.extent( 0 ),
+                         _n_basis, dim )
+        , _reference_points( reference_points )
+        , _cell_dofs_ids( cell_dofs_ids )
+        , _cells( cells )
+        , _columns( columns )
+        , _values( values )
+    {
+        DTK_REQUIRE( _columns.extent( 0 ) >=
+                     _entry_offset + reference_points.extent( 0 ) * _n_basis );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( int const i ) const
+    {
+        auto ref_point = Kokkos::subview( _reference_points, i, Kokkos::ALL() );
+        auto basis_values =
+            Kokkos::subview( _basis_values, i, Kokkos::ALL(), Kokkos::ALL() );
+        BasisType::getValues( basis_values, ref_point );
+
+        for ( unsigned int j = 0; j < _n_basis; ++j )
+        {
+            unsigned int const k = _entry_offset + i * _n_basis + j;
+            _columns( k ) = _cell_dofs_ids( _cells( i ), j );
+            _values( k ) = 0.;
+            for ( unsigned int d = 0; d < _dim; ++d )
+                _values( k ) += basis_values( j, d );
+        }
+    }
+
+  private:
+    unsigned int const _dim;
+    unsigned int const _n_basis;
+    unsigned int const _entry_offset;
+    Kokkos::DynRankView<Coordinate, DeviceType> _basis_values;
+    Kokkos::View<Coordinate **, DeviceType> _reference_points;
+    Kokkos::View<LocalOrdinal **, DeviceType> _cell_dofs_ids;
+    Kokkos::View<int *, DeviceType> _cells;
+    Kokkos::View<LocalOrdinal *, DeviceType> _columns;
+    Kokkos::View<Coordinate *, DeviceType> _values;
+};
+
+template <typename BasisType, typename DeviceType>
+class HgradTabulation
+{
+  public:
+    HgradTabulation( Kokkos::View<Coordinate **, DeviceType> reference_points,
+                     Kokkos::View<LocalOrdinal **, DeviceType> cell_dofs_ids,
+                     Kokkos::View<int *, DeviceType> cells,
+                     unsigned int const entry_offset,
+                     Kokkos::View<LocalOrdinal *, DeviceType> columns,
+                     Kokkos::View<Coordinate *, DeviceType> values )
+        : _n_basis( cell_dofs_ids.extent( 1 ) )
+        , _entry_offset( entry_offset )
+        , _reference_points( reference_points )
+        , _cell_dofs_ids( cell_dofs_ids )
+        , _cells( cells )
+        , _columns( columns )
+        , _values( values )
+    {
+        DTK_REQUIRE( _columns.extent( 0 ) >=
+                     _entry_offset + reference_points.extent( 0 ) * _n_basis );
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( int const i ) const
+    {
+        // The basis values are written directly in the matrix.
+        auto ref_point = Kokkos::subview( _reference_points, i, Kokkos::ALL() );
+        unsigned int const begin = _entry_offset + i * _n_basis;
+        auto basis_values = Kokkos::subview(
+            _values, Kokkos::make_pair( begin, begin + _n_basis ) );
+        BasisType::getValues( basis_values, ref_point );
+
+        for ( unsigned int j = 0; j < _n_basis; ++j )
+            _columns( begin + j ) = _cell_dofs_ids( _cells( i ), j );
+    }
+
+  private:
+    unsigned int _n_basis;
+    unsigned int _entry_offset;
+    Kokkos::View<Coordinate **, DeviceType> _reference_points;
+    Kokkos::View<LocalOrdinal **, DeviceType> _cell_dofs_ids;
+    Kokkos::View<int *, DeviceType> _cells;
+    Kokkos::View<LocalOrdinal *, DeviceType> _columns;
+    Kokkos::View<Coordinate *, DeviceType> _values;
+};
 } // namespace Functor
 } // namespace DataTransferKit
 
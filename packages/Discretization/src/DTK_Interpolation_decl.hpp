@@ -19,6 +19,7 @@
 #include <DTK_InterpolationFunctor.hpp>
 #include <DTK_Mesh.hpp>
 #include <DTK_PointSearch.hpp>
+#include <DTK_SourceMeshIndex.hpp>
 #include <DTK_Topology.hpp>
 
 #include <Intrepid2_FunctionSpaceTools.hpp>
@@ -26,6 +27,7 @@
 #include <mpi.h>
 
 #include <array>
+#include <memory>
 #include <string>
 
 namespace DataTransferKit
@@ -48,11 +50,35 @@ class Interpolation
      * cells * n dofs per cell)
      * @param fe_type type of the finite element (DTK_HGRAD, DTK_HDIV, or
      * DTK_CURL)
+     * @param build_interpolation_matrix if true, the basis functions are
+     * evaluated once and stored in a sparse matrix. apply() then performs a
+     * matrix-vector multiplication instead of evaluating the basis functions.
      */
     Interpolation( MPI_Comm comm, Mesh<DeviceType> const &mesh,
                    Kokkos::View<Coordinate **, DeviceType> points_coordinates,
                    Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids,
-                   DTK_FEType fe_type );
+                   DTK_FEType fe_type,
+                   bool build_interpolation_matrix = false );
+
+    /**
+     * Constructor.
+     * @param source_mesh_index preprocessed mesh of the domain of interest. It
+     * can be shared with other Interpolation and PointSearch objects.
+     * @param points_coordinates coordinates in the physical frame of the points
+     * that we are looking for (n phys points, dim)
+     * @param cell_dof_ids degrees of freedom indices associated to each cell (n
+     * cells * n dofs per cell)
+     * @param fe_type type of the finite element (DTK_HGRAD, DTK_HDIV, or
+     * DTK_CURL)
+     * @param build_interpolation_matrix if true, the basis functions are
+     * evaluated once and stored in a sparse matrix. apply() then performs a
+     * matrix-vector multiplication instead of evaluating the basis functions.
+     */
+    Interpolation(
+        std::shared_ptr<SourceMeshIndex<DeviceType> const> source_mesh_index,
+        Kokkos::View<Coordinate **, DeviceType> points_coordinates,
+        Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids,
+        DTK_FEType fe_type, bool build_interpolation_matrix = false );
 
     /**
      * This function performs the interpolation.
@@ -67,11 +93,38 @@ class Interpolation
     apply( Kokkos::View<Scalar **, DeviceType> X,
            Kokkos::View<Scalar **, DeviceType> Y );
 
-  private:
+    /**
+     * Evaluate the basis functions at the reference points and store them in
+     * a sparse matrix. The rows of the matrix are the reference points sorted
+     * by topology and the columns are the degrees of freedom.
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
+    void buildInterpolationMatrix();
+
+    /**
+     * Compute where each value received by apply() must be written in the
+     * output. This only depends on the search, so it is done once instead of
+     * sending the query ids and sorting them in every call to apply().
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
+    void buildImportPermutation();
+
+    /**
+     * Keep the dofs ids of the cells where a point was found. The dofs ids of
+     * a cell are stored once even if several points are found in the cell.
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
     void filter_dofs_ids(
         Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies,
-        Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids,
-        DTK_FEType fe_type );
+        Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids );
+
+  private:
 
     /**
      * Helper function that calls Functor::Interpolation.
@@ -79,6 +132,7 @@ class Interpolation
     template <typename Scalar, typename FEOpType>
     void interpolate( Kokkos::View<Coordinate **, DeviceType> ref_points,
                       Kokkos::View<LocalOrdinal **, DeviceType> cell_dofs_ids,
+                      Kokkos::View<int *, DeviceType> cells,
                       Kokkos::View<Scalar **, DeviceType> X,
                       Kokkos::View<Scalar **, DeviceType> Y );
 
@@ -89,6 +143,7 @@ class Interpolation
     void
     hgradInterpolate( Kokkos::View<Coordinate **, DeviceType> ref_points,
                       Kokkos::View<LocalOrdinal **, DeviceType> cell_dofs_ids,
+                      Kokkos::View<int *, DeviceType> cells,
                       Kokkos::View<Scalar **, DeviceType> X,
                       Kokkos::View<Scalar **, DeviceType> Y );
 
@@ -97,17 +152,55 @@ class Interpolation
                               Kokkos::View<Scalar **, DeviceType> X,
                               Kokkos::View<Scalar **, DeviceType> Y_fe );
 
+    /**
+     * Helper function that calls Functor::Tabulation.
+     */
+    template <typename FEOpType>
+    void tabulate( unsigned int topo_id, unsigned int entry_offset );
+
+    /**
+     * Helper function that calls Functor::HgradTabulation.
+     */
+    template <typename FEOpType>
+    void hgradTabulate( unsigned int topo_id, unsigned int entry_offset );
+
+    void tabulateDispatch( FE fe, unsigned int topo_id,
+                           unsigned int entry_offset );
+
     PointSearch<DeviceType> _point_search;
 
     /**
-     * Dofs ids associated to each node of the cells.
+     * Dofs ids associated to each node of the cells where a point was found.
      */
     std::array<Kokkos::View<LocalOrdinal **, DeviceType>, DTK_N_TOPO> _dofs_ids;
 
+    /**
+     * Row of _dofs_ids associated to each reference point.
+     */
+    std::array<Kokkos::View<int *, DeviceType>, DTK_N_TOPO> _dofs_cells;
+
     /**
      * Map between the finite element index and the finite element basis.
      */
     std::array<FE, DTK_N_TOPO> _finite_elements;
+
+    /**
+     * Interpolation matrix in CRS format. These Views are empty if the matrix
+     * has not been built.
+     */
+    Kokkos::View<unsigned int *, DeviceType> _matrix_row_ptr;
+    Kokkos::View<LocalOrdinal *, DeviceType> _matrix_columns;
+    Kokkos::View<Coordinate *, DeviceType> _matrix_values;
+
+    /**
+     * Row of the output where each imported value is written.
+     */
+    Kokkos::View<int *, DeviceType> _import_destinations;
+
+    /**
+     * Query ids of the points that have been found, sorted by increasing id.
+     */
+    Kokkos::View<int *, DeviceType> _found_query_ids;
 };
 
 template <typename DeviceType>
@@ -128,13 +221,35 @@ Interpolation<DeviceType>::apply( Kokkos::View<Scalar **, DeviceType> X,
     Kokkos::View<Scalar **, DeviceType> Y_buffer( "Y_buffer", n_local_ref_pts,
                                                   n_fields );
 
+    if ( _matrix_row_ptr.extent( 0 ) != 0 )
+    {
+        // Y_buffer = M X
+        auto row_ptr = _matrix_row_ptr;
+        auto columns = _matrix_columns;
+        auto values = _matrix_values;
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "apply_interpolation_matrix" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_local_ref_pts ),
+            KOKKOS_LAMBDA( int const i ) {
+                for ( unsigned int k = 0; k < n_fields; ++k )
+                {
+                    Scalar value = 0.;
+                    for ( unsigned int j = row_ptr( i ); j < row_ptr( i + 1 );
+                          ++j )
+                        value += values( j ) * X( columns( j ), k );
+                    Y_buffer( i, k ) = value;
+                }
+            } );
+        Kokkos::fence();
+    }
+
     unsigned int offset = 0;
     for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
     {
         unsigned int const n_ref_points =
             _point_search._reference_points[topo_id].extent( 0 );
 
-        if ( n_ref_points != 0 )
+        if ( ( n_ref_points != 0 ) && ( _matrix_row_ptr.extent( 0 ) == 0 ) )
         {
             // Perform the interpolation itself
             Kokkos::View<Scalar **, DeviceType> Y_fe(
@@ -154,83 +269,33 @@ Interpolation<DeviceType>::apply( Kokkos::View<Scalar **, DeviceType> X,
         }
     }
 
-    // Communicate the results, i.e, Y and the associated query ids
-    Kokkos::View<unsigned int *, DeviceType> query_ids( "query_ids",
-                                                        n_local_ref_pts );
-    unsigned int n_copied_pts = 0;
-    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
-    {
-        unsigned int const size = _point_search._query_ids[topo_id].extent( 0 );
-        auto topo_query_ids = _point_search._query_ids[topo_id];
-        Kokkos::parallel_for( DTK_MARK_REGION( "query_ids" ),
-                              Kokkos::RangePolicy<ExecutionSpace>( 0, size ),
-                              KOKKOS_LAMBDA( int const i ) {
-                                  query_ids( i + n_copied_pts ) =
-                                      topo_query_ids( i );
-                              } );
-        Kokkos::fence();
-
-        n_copied_pts += size;
-    }
-    unsigned int n_imports =
-        _point_search._target_to_source_distributor.getTotalReceiveLength();
-    Kokkos::View<unsigned int *, DeviceType> imported_query_ids(
-        "imported_query_ids", n_imports );
+    // Communicate the results and put them back in the initial order of the
+    // queries
+    unsigned int const n_imports = _import_destinations.extent( 0 );
     Kokkos::View<Scalar **, DeviceType> imported_Y( "imported_Y", n_imports,
                                                     n_fields );
-    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
-        space, _point_search._target_to_source_distributor, query_ids,
-        imported_query_ids );
     ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
         space, _point_search._target_to_source_distributor, Y_buffer,
         imported_Y );
 
+    auto import_destinations = _import_destinations;
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "fill_Y" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
+        KOKKOS_LAMBDA( int const i ) {
+            int const k = import_destinations( i );
+            for ( unsigned int j = 0; j < n_fields; ++j )
+                Y( k, j ) = imported_Y( i, j );
+        } );
+    Kokkos::fence();
+
     Kokkos::View<int *, DeviceType> found_query_ids( "found_query_ids",
                                                      Y.extent( 0 ) );
     Kokkos::deep_copy( found_query_ids, -1 );
-
-    if ( n_imports != 0 )
-    {
-        // Because of the MPI communications and the sorting by topologies, all
-        // the queries have been reordered. So we put them back in the initial
-        // order using the query ids.
-        ArborX::Details::DistributedTreeImpl<DeviceType>::sortResults(
-            space, imported_query_ids, imported_query_ids, imported_Y );
-
-        // We have finally all the values in the right order but before we can
-        // finally return the values we need to filter the data one more time.
-        // Some points are correctly found on multiple cells, e.g., point on
-        // vertices, so we need to get rid of the duplicates.
-        Kokkos::View<unsigned int *, DeviceType> mask( "mask", n_imports );
-        Kokkos::deep_copy( mask, 1 );
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "compute_mask" ),
-            Kokkos::RangePolicy<ExecutionSpace>( 1, n_imports ),
-            KOKKOS_LAMBDA( int const i ) {
-                if ( imported_query_ids( i - 1 ) == imported_query_ids( i ) )
-                    mask( i ) = 0;
-            } );
-        Kokkos::fence();
-
-        Kokkos::View<unsigned int *, DeviceType> query_offset( "query_offset",
-                                                               n_imports );
-        ArborX::exclusivePrefixSum( space, mask, query_offset );
-
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "fill_Y" ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
-            KOKKOS_LAMBDA( int const i ) {
-                if ( ( i == 0 ) || ( imported_query_ids( i - 1 ) !=
-                                     imported_query_ids( i ) ) )
-                {
-                    unsigned int k = query_offset( i );
-                    for ( unsigned int j = 0; j < n_fields; ++j )
-                        Y( k, j ) = imported_Y( i, j );
-                    found_query_ids( k ) = imported_query_ids( i );
-                }
-            } );
-        Kokkos::fence();
-    }
+    unsigned int const n_found = _found_query_ids.extent( 0 );
+    Kokkos::deep_copy(
+        Kokkos::subview( found_query_ids, Kokkos::make_pair( 0u, n_found ) ),
+        _found_query_ids );
 
     return found_query_ids;
 }
@@ -240,12 +305,13 @@ template <typename Scalar, typename FEOpType>
 void Interpolation<DeviceType>::interpolate(
     Kokkos::View<Coordinate **, DeviceType> ref_points,
     Kokkos::View<LocalOrdinal **, DeviceType> cell_dofs_ids,
+    Kokkos::View<int *, DeviceType> cells,
     Kokkos::View<Scalar **, DeviceType> X,
     Kokkos::View<Scalar **, DeviceType> Y_fe )
 {
     using ExecutionSpace = typename DeviceType::execution_space;
     Functor::Interpolation<Scalar, FEOpType, DeviceType> interpolation_functor(
-        _point_search._dim, ref_points, cell_dofs_ids, X, Y_fe );
+        _point_search._dim, ref_points, cell_dofs_ids, cells, X, Y_fe );
     Kokkos::parallel_for(
         DTK_MARK_REGION( "interpolate" ),
         Kokkos::RangePolicy<ExecutionSpace>( 0, ref_points.extent( 0 ) ),
@@ -257,12 +323,13 @@ template <typename Scalar, typename FEOpType>
 void Interpolation<DeviceType>::hgradInterpolate(
     Kokkos::View<Coordinate **, DeviceType> ref_points,
     Kokkos::View<LocalOrdinal **, DeviceType> cell_dofs_ids,
+    Kokkos::View<int *, DeviceType> cells,
     Kokkos::View<Scalar **, DeviceType> X,
     Kokkos::View<Scalar **, DeviceType> Y_fe )
 {
     using ExecutionSpace = typename DeviceType::execution_space;
     Functor::HgradInterpolation<Scalar, FEOpType, DeviceType>
-        interpolation_functor( ref_points, cell_dofs_ids, X, Y_fe );
+        interpolation_functor( ref_points, cell_dofs_ids, cells, X, Y_fe );
     Kokkos::parallel_for(
         DTK_MARK_REGION( "interpolate" ),
         Kokkos::RangePolicy<ExecutionSpace>( 0, ref_points.extent( 0 ) ),
@@ -281,136 +348,136 @@ void Interpolation<DeviceType>::interpolateDispatch(
     case FE::HEX_HCURL_1:
     {
         interpolate<Scalar, HEX_HCURL_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::HEX_HDIV_1:
     {
         interpolate<Scalar, HEX_HDIV_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::HEX_HGRAD_1:
     {
         hgradInterpolate<Scalar, HEX_HGRAD_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::HEX_HGRAD_2:
     {
         hgradInterpolate<Scalar, HEX_HGRAD_2::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::PYR_HGRAD_1:
     {
         hgradInterpolate<Scalar, PYR_HGRAD_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::QUAD_HCURL_1:
     {
         interpolate<Scalar, QUAD_HCURL_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::QUAD_HDIV_1:
     {
         interpolate<Scalar, QUAD_HDIV_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::QUAD_HGRAD_1:
     {
         hgradInterpolate<Scalar, QUAD_HGRAD_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::QUAD_HGRAD_2:
     {
         hgradInterpolate<Scalar, QUAD_HGRAD_2::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::TET_HCURL_1:
     {
         interpolate<Scalar, TET_HCURL_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::TET_HDIV_1:
     {
         interpolate<Scalar, TET_HDIV_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::TET_HGRAD_1:
     {
         hgradInterpolate<Scalar, TET_HGRAD_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::TET_HGRAD_2:
     {
         hgradInterpolate<Scalar, TET_HGRAD_2::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::TRI_HGRAD_1:
     {
         hgradInterpolate<Scalar, TRI_HGRAD_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::TRI_HGRAD_2:
     {
         hgradInterpolate<Scalar, TRI_HGRAD_2::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::WEDGE_HGRAD_1:
     {
         hgradInterpolate<Scalar, WEDGE_HGRAD_1::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
     case FE::WEDGE_HGRAD_2:
     {
         hgradInterpolate<Scalar, WEDGE_HGRAD_2::feop_type>(
-            _point_search._reference_points[topo_id], _dofs_ids[topo_id], X,
-            Y_fe );
+            _point_search._reference_points[topo_id], _dofs_ids[topo_id],
+            _dofs_cells[topo_id], X, Y_fe );
 
         break;
     }
@@ -21,8 +21,22 @@ template <typename DeviceType>
 Interpolation<DeviceType>::Interpolation(
     MPI_Comm comm, Mesh<DeviceType> const &mesh,
     Kokkos::View<Coordinate **, DeviceType> points_coordinates,
-    Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids, DTK_FEType fe_type )
-    : _point_search( comm, mesh, points_coordinates )
+    Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids, DTK_FEType fe_type,
+    bool build_interpolation_matrix )
+    : Interpolation(
+          std::make_shared<SourceMeshIndex<DeviceType> const>( comm, mesh ),
+          points_coordinates, cell_dof_ids, fe_type,
+          build_interpolation_matrix )
+{
+}
+
+template <typename DeviceType>
+Interpolation<DeviceType>::Interpolation(
+    std::shared_ptr<SourceMeshIndex<DeviceType> const> source_mesh_index,
+    Kokkos::View<Coordinate **, DeviceType> points_coordinates,
+    Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids, DTK_FEType fe_type,
+    bool build_interpolation_matrix )
+    : _point_search( source_mesh_index, points_coordinates, true )
 {
     // Fill up _finite_element, i.e., fill up a map between topo_id and FE
     Topologies topologies;
@@ -30,71 +44,358 @@ Interpolation<DeviceType>::Interpolation(
         _finite_elements[topo_id] = getFE( topologies[topo_id].topo, fe_type );
 
     // Change the format of cell_dofs_ids
-    filter_dofs_ids( mesh.cell_topologies, cell_dof_ids, fe_type );
+    filter_dofs_ids( source_mesh_index->_mesh.cell_topologies, cell_dof_ids );
+
+    buildImportPermutation();
+
+    if ( build_interpolation_matrix )
+        buildInterpolationMatrix();
 }
 
 template <typename DeviceType>
-void Interpolation<DeviceType>::filter_dofs_ids(
-    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies,
-    Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids, DTK_FEType fe_type )
+void Interpolation<DeviceType>::buildImportPermutation()
 {
-    // We need to filter the dof_ids and only keep the cells where a point
-    // was found. Because multiple points may be in the same cells, the
-    // cells may be duplicated.
-    // TODO do this on the device
-    auto cell_topologies_host = Kokkos::create_mirror_view( cell_topologies );
-    Kokkos::deep_copy( cell_topologies_host, cell_topologies );
+    using ExecutionSpace = typename DeviceType::execution_space;
+    ExecutionSpace space;
 
-    unsigned int const n_cells = cell_topologies.extent( 0 );
-    // We need to compute the number of basis function for each cell because the
-    // number of basis functions is different for HGRAD, HDIV, and HCURL.
-    // Therefore, knowing the number of nodes in the topology is not enough.
-    std::vector<unsigned int> dof_offset( n_cells + 1 );
-    for ( unsigned int i = 0; i < n_cells; ++i )
+    // Send the query ids in the same order as the values in apply()
+    unsigned int n_local_ref_pts = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+        n_local_ref_pts += _point_search._query_ids[topo_id].extent( 0 );
+    Kokkos::View<unsigned int *, DeviceType> query_ids( "query_ids",
+                                                        n_local_ref_pts );
+    unsigned int n_copied_pts = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
     {
-        auto fe = getFE( cell_topologies_host( i ), fe_type );
-        dof_offset[i + 1] = dof_offset[i] + getCardinality<DeviceType>( fe );
+        unsigned int const size = _point_search._query_ids[topo_id].extent( 0 );
+        auto topo_query_ids = _point_search._query_ids[topo_id];
+        Kokkos::parallel_for( DTK_MARK_REGION( "query_ids" ),
+                              Kokkos::RangePolicy<ExecutionSpace>( 0, size ),
+                              KOKKOS_LAMBDA( int const i ) {
+                                  query_ids( i + n_copied_pts ) =
+                                      topo_query_ids( i );
+                              } );
+        Kokkos::fence();
+
+        n_copied_pts += size;
     }
+    unsigned int const n_imports =
+        _point_search._target_to_source_distributor.getTotalReceiveLength();
+    Kokkos::View<unsigned int *, DeviceType> imported_query_ids(
+        "imported_query_ids", n_imports );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _point_search._target_to_source_distributor, query_ids,
+        imported_query_ids );
 
-    auto cell_dof_ids_host = Kokkos::create_mirror_view( cell_dof_ids );
-    Kokkos::deep_copy( cell_dof_ids_host, cell_dof_ids );
-    std::array<std::vector<std::vector<unsigned int>>, DTK_N_TOPO>
-        filtered_dof_ids;
-    // For each topo_id (finite element type) we reformat cell_dof_ids
+    _import_destinations =
+        Kokkos::View<int *, DeviceType>( "import_destinations", n_imports );
+    _found_query_ids =
+        Kokkos::View<int *, DeviceType>( "found_query_ids", n_imports );
+    if ( n_imports == 0 )
+        return;
+
+    // Because of the MPI communications and the sorting by topologies, all
+    // the queries have been reordered. We compute the permutation that puts
+    // them back in the initial order using the query ids.
+    Kokkos::View<unsigned int *, DeviceType> permutation( "permutation",
+                                                          n_imports );
+    ArborX::iota( space, permutation );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sortResults(
+        space, imported_query_ids, imported_query_ids, permutation );
+
+    // The point search only keeps one cell per point so every imported value
+    // corresponds to a different query.
+    auto import_destinations = _import_destinations;
+    auto found_query_ids = _found_query_ids;
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "compute_import_destinations" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
+        KOKKOS_LAMBDA( int const i ) {
+            import_destinations( permutation( i ) ) = i;
+            found_query_ids( i ) = imported_query_ids( i );
+        } );
+    Kokkos::fence();
+}
+
+template <typename DeviceType>
+void Interpolation<DeviceType>::buildInterpolationMatrix()
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    // The rows of the matrix are ordered like Y_buffer in apply(): the
+    // reference points of the first topology, then the reference points of the
+    // second topology, etc. Each row has one entry per basis function.
+    unsigned int n_local_ref_pts = 0;
+    unsigned int n_entries = 0;
     for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
     {
-        unsigned int const n_dofs_per_cell =
-            getCardinality<DeviceType>( _finite_elements[topo_id] );
+        unsigned int const n_ref_points =
+            _point_search._reference_points[topo_id].extent( 0 );
+        n_local_ref_pts += n_ref_points;
+        n_entries += n_ref_points * _dofs_ids[topo_id].extent( 1 );
+    }
+
+    _matrix_row_ptr = Kokkos::View<unsigned int *, DeviceType>(
+        "interpolation_matrix_row_ptr", n_local_ref_pts + 1 );
+    _matrix_columns = Kokkos::View<LocalOrdinal *, DeviceType>(
+        "interpolation_matrix_columns", n_entries );
+    _matrix_values = Kokkos::View<Coordinate *, DeviceType>(
+        "interpolation_matrix_values", n_entries );
 
-        // For each cell which contains a target point, we reformat cell_dof_ids
-        for ( unsigned int i = 0;
-              i < _point_search._query_ids[topo_id].extent( 0 ); ++i )
+    auto row_ptr = _matrix_row_ptr;
+    unsigned int row_offset = 0;
+    unsigned int entry_offset = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+    {
+        unsigned int const n_ref_points =
+            _point_search._reference_points[topo_id].extent( 0 );
+
+        if ( n_ref_points != 0 )
         {
-            unsigned int const cell_id =
-                _point_search._cell_indices_map
-                    [topo_id][_point_search._cell_indices[topo_id]( i )];
-            unsigned int const offset = dof_offset[cell_id];
-            std::vector<unsigned int> current_cell_dof_ids( n_dofs_per_cell );
-            for ( unsigned int j = 0; j < n_dofs_per_cell; ++j )
-                current_cell_dof_ids[j] = cell_dof_ids_host( offset + j );
-            filtered_dof_ids[topo_id].push_back( current_cell_dof_ids );
+            unsigned int const n_basis = _dofs_ids[topo_id].extent( 1 );
+            Kokkos::parallel_for(
+                DTK_MARK_REGION( "fill_row_ptr" ),
+                Kokkos::RangePolicy<ExecutionSpace>( 0, n_ref_points ),
+                KOKKOS_LAMBDA( int const i ) {
+                    row_ptr( row_offset + i + 1 ) =
+                        entry_offset + ( i + 1 ) * n_basis;
+                } );
+
+            tabulateDispatch( _finite_elements[topo_id], topo_id,
+                              entry_offset );
+
+            row_offset += n_ref_points;
+            entry_offset += n_ref_points * n_basis;
         }
     }
+    Kokkos::fence();
+}
+
+template <typename DeviceType>
+template <typename FEOpType>
+void Interpolation<DeviceType>::tabulate( unsigned int topo_id,
+                                          unsigned int entry_offset )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    auto ref_points = _point_search._reference_points[topo_id];
+    Functor::Tabulation<FEOpType, DeviceType> tabulation_functor(
+        _point_search._dim, ref_points, _dofs_ids[topo_id],
+        _dofs_cells[topo_id], entry_offset, _matrix_columns, _matrix_values );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "tabulate" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, ref_points.extent( 0 ) ),
+        tabulation_functor );
+}
+
+template <typename DeviceType>
+template <typename FEOpType>
+void Interpolation<DeviceType>::hgradTabulate( unsigned int topo_id,
+                                               unsigned int entry_offset )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    auto ref_points = _point_search._reference_points[topo_id];
+    Functor::HgradTabulation<FEOpType, DeviceType> tabulation_functor(
+        ref_points, _dofs_ids[topo_id], _dofs_cells[topo_id], entry_offset,
+        _matrix_columns, _matrix_values );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "tabulate" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, ref_points.extent( 0 ) ),
+        tabulation_functor );
+}
+
+template <typename DeviceType>
+void Interpolation<DeviceType>::tabulateDispatch( FE fe, unsigned int topo_id,
+                                                  unsigned int entry_offset )
+{
+    switch ( fe )
+    {
+    case FE::HEX_HCURL_1:
+    {
+        tabulate<HEX_HCURL_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::HEX_HDIV_1:
+    {
+        tabulate<HEX_HDIV_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::HEX_HGRAD_1:
+    {
+        hgradTabulate<HEX_HGRAD_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::HEX_HGRAD_2:
+    {
+        hgradTabulate<HEX_HGRAD_2::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::PYR_HGRAD_1:
+    {
+        hgradTabulate<PYR_HGRAD_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::QUAD_HCURL_1:
+    {
+        tabulate<QUAD_HCURL_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::QUAD_HDIV_1:
+    {
+        tabulate<QUAD_HDIV_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::QUAD_HGRAD_1:
+    {
+        hgradTabulate<QUAD_HGRAD_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::QUAD_HGRAD_2:
+    {
+        hgradTabulate<QUAD_HGRAD_2::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::TET_HCURL_1:
+    {
+        tabulate<TET_HCURL_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::TET_HDIV_1:
+    {
+        tabulate<TET_HDIV_1::feop_type>( topo_id, entry_offset );
 
-    // Copy in a Kokkos::View and then move it to the device
+        break;
+    }
+    case FE::TET_HGRAD_1:
+    {
+        hgradTabulate<TET_HGRAD_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::TET_HGRAD_2:
+    {
+        hgradTabulate<TET_HGRAD_2::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::TRI_HGRAD_1:
+    {
+        hgradTabulate<TRI_HGRAD_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::TRI_HGRAD_2:
+    {
+        hgradTabulate<TRI_HGRAD_2::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::WEDGE_HGRAD_1:
+    {
+        hgradTabulate<WEDGE_HGRAD_1::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    case FE::WEDGE_HGRAD_2:
+    {
+        hgradTabulate<WEDGE_HGRAD_2::feop_type>( topo_id, entry_offset );
+
+        break;
+    }
+    default:
+        throw DataTransferKitNotImplementedException();
+    }
+}
+
+template <typename DeviceType>
+void Interpolation<DeviceType>::filter_dofs_ids(
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies,
+    Kokkos::View<LocalOrdinal *, DeviceType> cell_dof_ids )
+{
+    // We need to filter the dof_ids and only keep the cells where a point
+    // was found. Because multiple points may be in the same cells, the dofs
+    // ids of a cell are stored once and each point stores the row of its
+    // cell.
+    using ExecutionSpace = typename DeviceType::execution_space;
+    ExecutionSpace space;
+
+    // We need to compute the number of basis function for each cell because the
+    // number of basis functions is different for HGRAD, HDIV, and HCURL.
+    // Therefore, knowing the number of nodes in the topology is not enough.
+    Kokkos::View<unsigned int[DTK_N_TOPO], DeviceType> n_dofs_per_topo(
+        "n_dofs_per_topo" );
+    auto n_dofs_per_topo_host = Kokkos::create_mirror_view( n_dofs_per_topo );
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+        n_dofs_per_topo_host( topo_id ) =
+            getCardinality<DeviceType>( _finite_elements[topo_id] );
+    Kokkos::deep_copy( n_dofs_per_topo, n_dofs_per_topo_host );
+
+    unsigned int const n_cells = cell_topologies.extent( 0 );
+    Kokkos::View<unsigned int *, DeviceType> dof_offset( "dof_offset",
+                                                         n_cells );
+    Discretization::Helpers::computeNodeOffset( cell_topologies,
+                                                n_dofs_per_topo, dof_offset );
+
+    // For each topo_id (finite element type) we reformat cell_dof_ids
+    Kokkos::View<unsigned int *, DeviceType> cell_found( "cell_found",
+                                                         n_cells );
+    Kokkos::View<unsigned int *, DeviceType> cell_rows( "cell_rows", n_cells );
     for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
     {
-        unsigned int const fe_n_cells = filtered_dof_ids[topo_id].size();
-        unsigned int const n_dofs_per_cell =
-            ( fe_n_cells > 0 ) ? filtered_dof_ids[topo_id][0].size() : 0;
+        auto cell_indices = _point_search._cell_indices[topo_id];
+        unsigned int const n_points = cell_indices.extent( 0 );
+        unsigned int const n_dofs_per_cell = n_dofs_per_topo_host( topo_id );
+
+        // Flag the cells where a point was found and number them
+        Kokkos::deep_copy( cell_found, 0 );
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "flag_found_cells" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+            KOKKOS_LAMBDA( int const i ) {
+                cell_found( cell_indices( i ) ) = 1;
+            } );
+        Kokkos::fence();
+        ArborX::exclusivePrefixSum( space, cell_found, cell_rows );
+        unsigned int const n_found_cells =
+            ( n_cells > 0 ) ? ArborX::lastElement( cell_rows ) +
+                                  ArborX::lastElement( cell_found )
+                            : 0;
+
+        // Copy the dofs ids of the found cells
         _dofs_ids[topo_id] = Kokkos::View<LocalOrdinal **, DeviceType>(
-            "cell_dofs_ids_" + std::to_string( topo_id ), fe_n_cells,
+            "cell_dofs_ids_" + std::to_string( topo_id ), n_found_cells,
             n_dofs_per_cell );
-        auto dofs_ids_host = Kokkos::create_mirror_view( _dofs_ids[topo_id] );
-        for ( unsigned int i = 0; i < fe_n_cells; ++i )
-            for ( unsigned int j = 0; j < n_dofs_per_cell; ++j )
-                dofs_ids_host( i, j ) = filtered_dof_ids[topo_id][i][j];
-        Kokkos::deep_copy( _dofs_ids[topo_id], dofs_ids_host );
+        auto dofs_ids = _dofs_ids[topo_id];
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "copy_dofs_ids" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+            KOKKOS_LAMBDA( int const i ) {
+                if ( cell_found( i ) )
+                    for ( unsigned int j = 0; j < n_dofs_per_cell; ++j )
+                        dofs_ids( cell_rows( i ), j ) =
+                            cell_dof_ids( dof_offset( i ) + j );
+            } );
+
+        // Store the row of the cell associated to each point
+        _dofs_cells[topo_id] = Kokkos::View<int *, DeviceType>(
+            "dofs_cells_" + std::to_string( topo_id ), n_points );
+        auto dofs_cells = _dofs_cells[topo_id];
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "compute_dofs_cells" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+            KOKKOS_LAMBDA( int const i ) {
+                dofs_cells( i ) = cell_rows( cell_indices( i ) );
+            } );
+        Kokkos::fence();
     }
 }
 
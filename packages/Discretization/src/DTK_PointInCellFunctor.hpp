@@ -12,25 +12,379 @@
 #ifndef DTK_POINT_IN_CELL_FUNCTOR_HPP
 #define DTK_POINT_IN_CELL_FUNCTOR_HPP
 
+#include <DTK_Topology.hpp>
+
 #include <Intrepid2_CellTools_Serial.hpp>
 #include <Kokkos_Macros.hpp>
 #include <Kokkos_View.hpp>
 
+#include <cmath>
+
 namespace DataTransferKit
 {
 namespace Functor
 {
+/**
+ * Solve the 2x2 or 3x3 linear system \p matrix \p x = \p rhs using the
+ * explicit inverse of the matrix. Return false if the matrix is singular.
+ */
+template <typename MatrixType>
+KOKKOS_INLINE_FUNCTION bool solveLinearSystem( int const dim,
+                                               MatrixType const &matrix,
+                                               double const *rhs, double *x )
+{
+    if ( dim == 2 )
+    {
+        double const det =
+            matrix( 0, 0 ) * matrix( 1, 1 ) - matrix( 0, 1 ) * matrix( 1, 0 );
+        if ( det == 0. )
+            return false;
+        x[0] = ( matrix( 1, 1 ) * rhs[0] - matrix( 0, 1 ) * rhs[1] ) / det;
+        x[1] = ( matrix( 0, 0 ) * rhs[1] - matrix( 1, 0 ) * rhs[0] ) / det;
+    }
+    else
+    {
+        double inv[3][3];
+        inv[0][0] =
+            matrix( 1, 1 ) * matrix( 2, 2 ) - matrix( 1, 2 ) * matrix( 2, 1 );
+        inv[0][1] =
+            matrix( 0, 2 ) * matrix( 2, 1 ) - matrix( 0, 1 ) * matrix( 2, 2 );
+        inv[0][2] =
+            matrix( 0, 1 ) * matrix( 1, 2 ) - matrix( 0, 2 ) * matrix( 1, 1 );
+        inv[1][0] =
+            matrix( 1, 2 ) * matrix( 2, 0 ) - matrix( 1, 0 ) * matrix( 2, 2 );
+        inv[1][1] =
+            matrix( 0, 0 ) * matrix( 2, 2 ) - matrix( 0, 2 ) * matrix( 2, 0 );
+        inv[1][2] =
+            matrix( 0, 2 ) * matrix( 1, 0 ) - matrix( 0, 0 ) * matrix( 1, 2 );
+        inv[2][0] =
+            matrix( 1, 0 ) * matrix( 2, 1 ) - matrix( 1, 1 ) * matrix( 2, 0 );
+        inv[2][1] =
+            matrix( 0, 1 ) * matrix( 2, 0 ) - matrix( 0, 0 ) * matrix( 2, 1 );
+        inv[2][2] =
+            matrix( 0, 0 ) * matrix( 1, 1 ) - matrix( 0, 1 ) * matrix( 1, 0 );
+        double const det = matrix( 0, 0 ) * inv[0][0] +
+                           matrix( 0, 1 ) * inv[1][0] +
+                           matrix( 0, 2 ) * inv[2][0];
+        if ( det == 0. )
+            return false;
+        for ( int d = 0; d < 3; ++d )
+            x[d] = ( inv[d][0] * rhs[0] + inv[d][1] * rhs[1] +
+                     inv[d][2] * rhs[2] ) /
+                   det;
+    }
+
+    return true;
+}
+
+/**
+ * Affine map between the reference cell and a physical cell: x = origin +
+ * matrix * ref_x. The default implementation is used for the topologies whose
+ * map is never treated as affine.
+ */
+template <typename CellType>
+struct AffineMap
+{
+    template <typename NodesType, typename MatrixType>
+    KOKKOS_INLINE_FUNCTION static bool build( int const, NodesType const &,
+                                              double *, MatrixType const & )
+    {
+        return false;
+    }
+};
+
+/**
+ * The map of a simplex is always affine. The reference vertices are the
+ * origin and the unit vectors, so the columns of the matrix are the edges
+ * starting at the first vertex.
+ */
+struct SimplexAffineMap
+{
+    template <typename NodesType, typename MatrixType>
+    KOKKOS_INLINE_FUNCTION static bool build( int const dim,
+                                              NodesType const &nodes,
+                                              double *origin,
+                                              MatrixType const &matrix )
+    {
+        for ( int d = 0; d < dim; ++d )
+        {
+            origin[d] = nodes( 0, d );
+            for ( int j = 0; j < dim; ++j )
+                matrix( d, j ) = nodes( j + 1, d ) - nodes( 0, d );
+        }
+
+        return true;
+    }
+};
+
+template <>
+struct AffineMap<TRI_3> : SimplexAffineMap
+{
+};
+
+template <>
+struct AffineMap<TET_4> : SimplexAffineMap
+{
+};
+
+/**
+ * The map of a quadrilateral or of a hexahedron is affine when the cell is a
+ * parallelogram or a parallelepiped, e.g. when the cell is aligned with the
+ * axes. The reference cell is [-1, 1]^dim so the origin is the center of the
+ * cell and the columns of the matrix are half the edges starting at the first
+ * vertex. The map is only used if every vertex is recovered.
+ */
+template <typename CellType>
+struct TensorAffineMap
+{
+    template <typename NodesType, typename MatrixType>
+    KOKKOS_INLINE_FUNCTION static bool build( int const dim,
+                                              NodesType const &nodes,
+                                              double *origin,
+                                              MatrixType const &matrix )
+    {
+        // Vertices adjacent to the first vertex along each reference axis
+        int const adjacent_vertex[3] = {1, 3, 4};
+        unsigned int constexpr n_vertices = CellType::n_nodes;
+        double scale = 0.;
+        for ( int d = 0; d < dim; ++d )
+        {
+            origin[d] = 0.;
+            for ( unsigned int n = 0; n < n_vertices; ++n )
+                origin[d] += nodes( n, d );
+            origin[d] /= n_vertices;
+            for ( int j = 0; j < dim; ++j )
+            {
+                matrix( d, j ) =
+                    0.5 * ( nodes( adjacent_vertex[j], d ) - nodes( 0, d ) );
+                if ( std::abs( matrix( d, j ) ) > scale )
+                    scale = std::abs( matrix( d, j ) );
+            }
+        }
+
+        // Check that the map recovers all the vertices. The coordinate of
+        // vertex n along the reference axis j is -1 or 1.
+        double const tol = 1e-12 * scale;
+        for ( unsigned int n = 0; n < n_vertices; ++n )
+        {
+            double const sign[3] = {( ( n + 1 ) % 4 < 2 ) ? -1. : 1.,
+                                    ( n % 4 < 2 ) ? -1. : 1.,
+                                    ( n < 4 ) ? -1. : 1.};
+            for ( int d = 0; d < dim; ++d )
+            {
+                double x = origin[d];
+                for ( int j = 0; j < dim; ++j )
+                    x += matrix( d, j ) * sign[j];
+                if ( std::abs( x - nodes( n, d ) ) > tol )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+template <>
+struct AffineMap<QUAD_4> : TensorAffineMap<QUAD_4>
+{
+};
+
+template <>
+struct AffineMap<HEX_8> : TensorAffineMap<HEX_8>
+{
+};
+
+/**
+ * Compute the coordinates of \p phys_point in the reference frame in closed
+ * form when the map between the reference cell and the cell defined by \p
+ * nodes is affine. Return false and leave \p ref_point untouched otherwise.
+ */
+template <typename CellType, typename DeviceType, typename RefPointType,
+          typename PhysPointType, typename NodesType>
+KOKKOS_INLINE_FUNCTION bool
+mapToReferenceFrameAffine( RefPointType const &ref_point,
+                           PhysPointType const &phys_point,
+                           NodesType const &nodes )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    using UnmanagedView2D =
+        Kokkos::View<double **, ExecutionSpace,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+
+    int const dim = ref_point.extent( 0 );
+    double origin[3];
+    double matrix_buffer[9];
+    UnmanagedView2D matrix( matrix_buffer, dim, dim );
+    if ( !AffineMap<CellType>::build( dim, nodes, origin, matrix ) )
+        return false;
+
+    double rhs[3];
+    for ( int d = 0; d < dim; ++d )
+        rhs[d] = phys_point( d ) - origin[d];
+    double x[3];
+    if ( !solveLinearSystem( dim, matrix, rhs, x ) )
+        return false;
+    for ( int d = 0; d < dim; ++d )
+        ref_point( d ) = x[d];
+
+    return true;
+}
+
+/**
+ * Newton solver that starts from the value in \p ref_point instead of the
+ * center of the reference cell. When the point has barely moved since the
+ * last search, the previous reference coordinates are a very good initial
+ * guess and only a couple of iterations are necessary. Return false if the
+ * solver did not converge, in which case \p ref_point is meaningless and the
+ * full solve must be used.
+ */
+template <typename CellType, typename DeviceType, typename RefPointType,
+          typename PhysPointType, typename NodesType>
+KOKKOS_INLINE_FUNCTION bool
+mapToReferenceFrameFromGuess( RefPointType const &ref_point,
+                              PhysPointType const &phys_point,
+                              NodesType const &nodes )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    using UnmanagedView1D =
+        Kokkos::View<double *, ExecutionSpace,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+    using UnmanagedView2D =
+        Kokkos::View<double **, ExecutionSpace,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+
+    int const dim = ref_point.extent( 0 );
+    double mapped_point_buffer[3];
+    double jacobian_buffer[9];
+    UnmanagedView1D mapped_point( mapped_point_buffer, dim );
+    UnmanagedView2D jacobian( jacobian_buffer, dim, dim );
+
+    int constexpr max_iter = 10;
+    double const tol = 1e-12;
+    for ( int iter = 0; iter < max_iter; ++iter )
+    {
+        // Residual r = p - F(ref_point)
+        using BasisType = typename CellType::basis_type;
+        Intrepid2::Impl::CellTools::Serial::mapToPhysicalFrame<BasisType>(
+            mapped_point, ref_point, nodes );
+        double r[3];
+        for ( int d = 0; d < dim; ++d )
+            r[d] = phys_point( d ) - mapped_point( d );
+
+        // Solve J dx = r
+        Intrepid2::Impl::CellTools::Serial::computeJacobian<BasisType>(
+            jacobian, ref_point, nodes );
+        double dx[3];
+        if ( !solveLinearSystem( dim, jacobian, r, dx ) )
+            return false;
+
+        double norm_dx = 0.;
+        for ( int d = 0; d < dim; ++d )
+        {
+            ref_point( d ) += dx[d];
+            norm_dx += dx[d] * dx[d];
+        }
+        if ( norm_dx < tol * tol )
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Return true if \p phys_point is outside of the cell defined by the vertices
+ * of a high-order cell by more than \p rejection_threshold in the reference
+ * frame. The map of this linear cell is much cheaper to invert than the map of
+ * the high-order cell and most of the candidates of the coarse search are
+ * rejected this way. Because the high-order cell can be curved, \p
+ * rejection_threshold needs to be larger than the threshold of the inclusion
+ * test. The test is disabled if \p rejection_threshold is negative.
+ */
+template <typename CellType, typename DeviceType, typename PhysPointType,
+          typename NodesType>
+KOKKOS_INLINE_FUNCTION bool
+rejectFromLinearCell( double const rejection_threshold,
+                      PhysPointType const &phys_point, NodesType const &nodes )
+{
+    using LinearCellType = typename CellType::linear_cell_type;
+    if ( ( CellType::n_nodes == LinearCellType::n_nodes ) ||
+         ( rejection_threshold < 0. ) )
+        return false;
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+    using UnmanagedView1D =
+        Kokkos::View<double *, ExecutionSpace,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+
+    // The vertices are the first nodes of the high-order cell
+    int const dim = phys_point.extent( 0 );
+    double linear_ref_point_buffer[3];
+    UnmanagedView1D linear_ref_point( linear_ref_point_buffer, dim );
+    unsigned int constexpr n_vertices = LinearCellType::n_nodes;
+    auto vertices = Kokkos::subview(
+        nodes, Kokkos::make_pair( 0u, n_vertices ), Kokkos::ALL() );
+    if ( !mapToReferenceFrameAffine<LinearCellType, DeviceType>(
+             linear_ref_point, phys_point, vertices ) )
+        Intrepid2::Impl::CellTools::Serial::mapToReferenceFrame<
+            typename LinearCellType::basis_type>( linear_ref_point,
+                                                  phys_point, vertices );
+
+    // Do not reject the point if the solver failed
+    for ( int d = 0; d < dim; ++d )
+        if ( linear_ref_point( d ) != linear_ref_point( d ) )
+            return false;
+
+    return !LinearCellType::topo_type::checkPointInclusion(
+        linear_ref_point, rejection_threshold );
+}
+
+/**
+ * Compute the coordinates of \p phys_point in the reference frame of the cell
+ * defined by \p nodes (n_nodes, dim) and return true if the point is inside
+ * the cell. High-order cells are first checked with rejectFromLinearCell().
+ * The reference point is not computed if the point is rejected.
+ */
+template <typename CellType, typename DeviceType, typename RefPointType,
+          typename PhysPointType, typename NodesType>
+KOKKOS_INLINE_FUNCTION bool
+pointInCell( double const threshold, double const rejection_threshold,
+             bool const use_initial_guess, RefPointType const &ref_point,
+             PhysPointType const &phys_point, NodesType const &nodes )
+{
+    // Cells with an affine map do not need the Newton solver
+    if ( mapToReferenceFrameAffine<CellType, DeviceType>( ref_point, phys_point,
+                                                          nodes ) )
+        return CellType::topo_type::checkPointInclusion( ref_point, threshold );
+
+    if ( rejectFromLinearCell<CellType, DeviceType>( rejection_threshold,
+                                                     phys_point, nodes ) )
+        return false;
+
+    // Fall back to the full solve, which starts from the center of the
+    // reference cell, if the solve from the initial guess did not converge.
+    if ( !use_initial_guess ||
+         !mapToReferenceFrameFromGuess<CellType, DeviceType>(
+             ref_point, phys_point, nodes ) )
+        Intrepid2::Impl::CellTools::Serial::mapToReferenceFrame<
+            typename CellType::basis_type>( ref_point, phys_point, nodes );
+
+    return CellType::topo_type::checkPointInclusion( ref_point, threshold );
+}
+
 template <typename CellType, typename DeviceType>
 class PointInCell
 {
   public:
-    PointInCell( double threshold,
+    PointInCell( double threshold, double rejection_threshold,
                  Kokkos::View<double **, DeviceType> physical_points,
                  Kokkos::View<double ***, DeviceType> cells,
                  Kokkos::View<int *, DeviceType> coarse_search_output_cells,
                  Kokkos::View<double **, DeviceType> reference_points,
-                 Kokkos::View<bool *, DeviceType> point_in_cell )
+                 Kokkos::View<bool *, DeviceType> point_in_cell,
+                 bool use_initial_guess = false )
         : _threshold( threshold )
+        , _rejection_threshold( rejection_threshold )
+        , _use_initial_guess( use_initial_guess )
         , _physical_points( physical_points )
         , _cells( cells )
         , _coarse_search_output_cells( coarse_search_output_cells )
@@ -56,20 +410,97 @@ class PointInCell
 
         // Compute the reference point and return true if the
         // point is inside the cell
-        Intrepid2::Impl::CellTools::Serial::mapToReferenceFrame<
-            typename CellType::basis_type>( ref_point, phys_point, nodes );
-        _point_in_cell[i] =
-            CellType::topo_type::checkPointInclusion( ref_point, _threshold );
+        _point_in_cell[i] = pointInCell<CellType, DeviceType>(
+            _threshold, _rejection_threshold, _use_initial_guess, ref_point,
+            phys_point, nodes );
     }
 
   private:
     double _threshold;
+    double _rejection_threshold;
+    bool _use_initial_guess;
     Kokkos::View<double **, DeviceType> _physical_points;
     Kokkos::View<double ***, DeviceType> _cells;
     Kokkos::View<int *, DeviceType> _coarse_search_output_cells;
     Kokkos::View<double **, DeviceType> _reference_points;
     Kokkos::View<bool *, DeviceType> _point_in_cell;
 };
+
+/**
+ * Same as PointInCell but the nodes of the cells are read directly from the
+ * connectivity and the coordinates of the mesh. The nodes of the current cell
+ * are gathered in a buffer on the stack so that no copy of the cells is
+ * needed.
+ */
+template <typename CellType, typename DeviceType>
+class PointInMeshCell
+{
+  public:
+    PointInMeshCell(
+        double threshold, double rejection_threshold,
+        Kokkos::View<double **, DeviceType> physical_points,
+        Kokkos::View<unsigned int *, DeviceType> cells,
+        Kokkos::View<unsigned int *, DeviceType> node_offset,
+        Kokkos::View<double **, DeviceType> nodes_coordinates,
+        Kokkos::View<int *, DeviceType> coarse_search_output_cells,
+        Kokkos::View<double **, DeviceType> reference_points,
+        Kokkos::View<bool *, DeviceType> point_in_cell,
+        bool use_initial_guess = false )
+        : _threshold( threshold )
+        , _rejection_threshold( rejection_threshold )
+        , _use_initial_guess( use_initial_guess )
+        , _physical_points( physical_points )
+        , _cells( cells )
+        , _node_offset( node_offset )
+        , _nodes_coordinates( nodes_coordinates )
+        , _coarse_search_output_cells( coarse_search_output_cells )
+        , _reference_points( reference_points )
+        , _point_in_cell( point_in_cell )
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()( unsigned int const i ) const
+    {
+        // Extract the indices computed by the coarse search
+        int const cell_index = _coarse_search_output_cells( i );
+        using ExecutionSpace = typename DeviceType::execution_space;
+        Kokkos::View<double *, Kokkos::LayoutStride, ExecutionSpace> ref_point(
+            _reference_points, i, Kokkos::ALL() );
+        Kokkos::View<double *, Kokkos::LayoutStride, ExecutionSpace> phys_point(
+            _physical_points, i, Kokkos::ALL() );
+
+        // Gather the nodes of the current cell (nodes, dim)
+        unsigned int constexpr n_nodes = CellType::n_nodes;
+        unsigned int const dim = _nodes_coordinates.extent( 1 );
+        unsigned int const offset = _node_offset( cell_index );
+        double nodes_buffer[n_nodes * 3];
+        Kokkos::View<double **, ExecutionSpace,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>
+            nodes( nodes_buffer, n_nodes, dim );
+        for ( unsigned int n = 0; n < n_nodes; ++n )
+            for ( unsigned int d = 0; d < dim; ++d )
+                nodes( n, d ) = _nodes_coordinates( _cells( offset + n ), d );
+
+        // Compute the reference point and return true if the
+        // point is inside the cell
+        _point_in_cell[i] = pointInCell<CellType, DeviceType>(
+            _threshold, _rejection_threshold, _use_initial_guess, ref_point,
+            phys_point, nodes );
+    }
+
+  private:
+    double _threshold;
+    double _rejection_threshold;
+    bool _use_initial_guess;
+    Kokkos::View<double **, DeviceType> _physical_points;
+    Kokkos::View<unsigned int *, DeviceType> _cells;
+    Kokkos::View<unsigned int *, DeviceType> _node_offset;
+    Kokkos::View<double **, DeviceType> _nodes_coordinates;
+    Kokkos::View<int *, DeviceType> _coarse_search_output_cells;
+    Kokkos::View<double **, DeviceType> _reference_points;
+    Kokkos::View<bool *, DeviceType> _point_in_cell;
+};
 } // namespace Functor
 } // namespace DataTransferKit
 
@@ -15,6 +15,7 @@
 #include "DTK_ConfigDefs.hpp"
 #include <DTK_CellTypes.h>
 #include <DTK_DBC.hpp>
+#include <DTK_Mesh.hpp>
 
 #include <Kokkos_View.hpp>
 
@@ -36,6 +37,10 @@ class PointInCell
      * reference space (coarse_output_size, dim)
      *    @param[out] point_in_cell Booleans with value true if the point is in
      * the cell and false otherwise (coarse_output_size)
+     *    @param[in] use_initial_guess If true, the values in \p
+     * reference_points are used as initial guess of the Newton solver.
+     * Otherwise, or if the solver does not converge from the initial guess,
+     * the solver starts from the center of the cell.
      */
     static void
     search( Kokkos::View<Coordinate **, DeviceType> physical_points,
@@ -43,7 +48,41 @@ class PointInCell
             Kokkos::View<int *, DeviceType> coarse_search_output_cells,
             DTK_CellTopology cell_topo,
             Kokkos::View<Coordinate **, DeviceType> reference_points,
-            Kokkos::View<bool *, DeviceType> point_in_cell );
+            Kokkos::View<bool *, DeviceType> point_in_cell,
+            bool use_initial_guess = false );
+
+    /**
+     * Performs the local search. Unlike the function above, the nodes of the
+     * cells are read directly from the connectivity of the mesh instead of
+     * being copied in a (n_cells, n_nodes, dim) View first.
+     *    @param[in] mesh Mesh owned by the processor. All the cells in \p
+     * coarse_search_output_cells must have the topology \p cell_topo.
+     *    @param[in] node_offset Position of the first node of each cell in
+     * \p mesh.cells (n_cells)
+     *    @param[in] physical_points The coordinates of the points in the
+     * physical space (coarse_output_size, dim)
+     *    @param[in] coarse_search_output_cells Indices of the cells in \p
+     * mesh from the coarse search (coarse_output_size)
+     *    @param[in] cell_topo Topology of the cells in \p
+     * coarse_search_output_cells
+     *    @param[out] reference_points The coordinates of the points in the
+     * reference space (coarse_output_size, dim)
+     *    @param[out] point_in_cell Booleans with value true if the point is in
+     * the cell and false otherwise (coarse_output_size)
+     *    @param[in] use_initial_guess If true, the values in \p
+     * reference_points are used as initial guess of the Newton solver.
+     * Otherwise, or if the solver does not converge from the initial guess,
+     * the solver starts from the center of the cell.
+     */
+    static void
+    search( Mesh<DeviceType> const &mesh,
+            Kokkos::View<unsigned int *, DeviceType> node_offset,
+            Kokkos::View<Coordinate **, DeviceType> physical_points,
+            Kokkos::View<int *, DeviceType> coarse_search_output_cells,
+            DTK_CellTopology cell_topo,
+            Kokkos::View<Coordinate **, DeviceType> reference_points,
+            Kokkos::View<bool *, DeviceType> point_in_cell,
+            bool use_initial_guess = false );
 
     /**
      * Same function as above. However, the function is virtual so that the user
@@ -79,6 +118,16 @@ class PointInCell
     }
 
     static double threshold;
+
+    /**
+     * Tolerance of the inclusion test in the cell defined by the vertices of
+     * a high-order cell. A candidate outside of this linear cell by more than
+     * rejection_threshold (in the reference frame) is rejected without
+     * inverting the map of the high-order cell. The value must be large enough
+     * to account for the curvature of the cells. A negative value disables the
+     * test.
+     */
+    static double rejection_threshold;
 };
 
 // Default value for threshold matches the inclusion tolerance in DTK-2.0 which
@@ -86,6 +135,9 @@ class PointInCell
 // https://github.com/ORNL-CEES/DataTransferKit/blob/dtk-2.0/packages/Adapters/Libmesh/src/DTK_LibmeshEntityLocalMap.cpp#L58
 template <typename DeviceType>
 double PointInCell<DeviceType>::threshold = 1e-6;
+
+template <typename DeviceType>
+double PointInCell<DeviceType>::rejection_threshold = 0.25;
 } // namespace DataTransferKit
 
 #endif
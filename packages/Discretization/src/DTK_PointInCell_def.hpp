@@ -23,40 +23,48 @@ namespace DataTransferKit
 namespace internal
 {
 template <typename CellType, typename DeviceType>
-void pointInCell( double threshold,
+void pointInCell( double threshold, double rejection_threshold,
                   Kokkos::View<Coordinate **, DeviceType> physical_points,
                   Kokkos::View<Coordinate ***, DeviceType> cells,
                   Kokkos::View<int *, DeviceType> coarse_search_output_cells,
                   Kokkos::View<Coordinate **, DeviceType> reference_points,
-                  Kokkos::View<bool *, DeviceType> point_in_cell )
+                  Kokkos::View<bool *, DeviceType> point_in_cell,
+                  bool use_initial_guess )
 {
     using ExecutionSpace = typename DeviceType::execution_space;
     int const n_ref_pts = reference_points.extent( 0 );
 
-    // Functor::PointInCell uses Intrepid2 which assumme that the coordinates of
-    // the point is double not float.
-    Kokkos::View<double **, DeviceType> physical_dp_points(
-        "physical_dp_points", physical_points.extent( 0 ),
-        physical_points.extent( 1 ) );
-    Kokkos::deep_copy( physical_dp_points, physical_points );
-    Kokkos::View<double ***, DeviceType> dp_cells(
-        "dp_cells", cells.extent( 0 ), cells.extent( 1 ), cells.extent( 2 ) );
-    Kokkos::deep_copy( dp_cells, cells );
-    Kokkos::View<double **, DeviceType> reference_dp_points(
-        "reference_dp_points", reference_points.extent( 0 ),
-        reference_points.extent( 1 ) );
-    Kokkos::deep_copy( reference_dp_points, reference_points );
-
+    // Functor::PointInCell uses Intrepid2 which assumes that the coordinates
+    // of the points are double. Since Coordinate is double, the Views can be
+    // used directly.
     Functor::PointInCell<CellType, DeviceType> search_functor(
-        threshold, physical_dp_points, dp_cells, coarse_search_output_cells,
-        reference_dp_points, point_in_cell );
+        threshold, rejection_threshold, physical_points, cells,
+        coarse_search_output_cells, reference_points, point_in_cell,
+        use_initial_guess );
     Kokkos::parallel_for( DTK_MARK_REGION( "point_in_cell" ),
                           Kokkos::RangePolicy<ExecutionSpace>( 0, n_ref_pts ),
                           search_functor );
+}
+
+template <typename CellType, typename DeviceType>
+void pointInMeshCell(
+    double threshold, double rejection_threshold, Mesh<DeviceType> const &mesh,
+    Kokkos::View<unsigned int *, DeviceType> node_offset,
+    Kokkos::View<Coordinate **, DeviceType> physical_points,
+    Kokkos::View<int *, DeviceType> coarse_search_output_cells,
+    Kokkos::View<Coordinate **, DeviceType> reference_points,
+    Kokkos::View<bool *, DeviceType> point_in_cell, bool use_initial_guess )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    int const n_ref_pts = reference_points.extent( 0 );
 
-    Kokkos::deep_copy( physical_points, physical_dp_points );
-    Kokkos::deep_copy( cells, dp_cells );
-    Kokkos::deep_copy( reference_points, reference_dp_points );
+    Functor::PointInMeshCell<CellType, DeviceType> search_functor(
+        threshold, rejection_threshold, physical_points, mesh.cells,
+        node_offset, mesh.nodes_coordinates, coarse_search_output_cells,
+        reference_points, point_in_cell, use_initial_guess );
+    Kokkos::parallel_for( DTK_MARK_REGION( "point_in_mesh_cell" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_ref_pts ),
+                          search_functor );
 }
 } // namespace internal
 
@@ -67,7 +75,7 @@ void PointInCell<DeviceType>::search(
     Kokkos::View<int *, DeviceType> coarse_search_output_cells,
     DTK_CellTopology cell_topo,
     Kokkos::View<Coordinate **, DeviceType> reference_points,
-    Kokkos::View<bool *, DeviceType> point_in_cell )
+    Kokkos::View<bool *, DeviceType> point_in_cell, bool use_initial_guess )
 {
     // Check the size of the Views
     DTK_REQUIRE( reference_points.extent( 0 ) == point_in_cell.extent( 0 ) );
@@ -85,78 +93,207 @@ void PointInCell<DeviceType>::search(
     case DTK_HEX_8:
     {
         internal::pointInCell<HEX_8, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_HEX_27:
     {
         internal::pointInCell<HEX_27, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_PYRAMID_5:
     {
         internal::pointInCell<PYRAMID_5, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_QUAD_4:
     {
         internal::pointInCell<QUAD_4, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_QUAD_9:
     {
         internal::pointInCell<QUAD_9, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_TET_4:
     {
         internal::pointInCell<TET_4, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_TET_10:
     {
         internal::pointInCell<TET_10, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_TRI_3:
     {
         internal::pointInCell<TRI_3, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_TRI_6:
     {
         internal::pointInCell<TRI_6, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_WEDGE_6:
     {
         internal::pointInCell<WEDGE_6, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
         break;
     }
     case DTK_WEDGE_18:
     {
         internal::pointInCell<WEDGE_18, DeviceType>(
-            threshold, physical_points, cells, coarse_search_output_cells,
-            reference_points, point_in_cell );
+            threshold, rejection_threshold, physical_points, cells,
+            coarse_search_output_cells, reference_points, point_in_cell,
+            use_initial_guess );
+        break;
+    }
+    default:
+    {
+        throw DataTransferKitNotImplementedException();
+    }
+    }
+    Kokkos::fence();
+}
+
+template <typename DeviceType>
+void PointInCell<DeviceType>::search(
+    Mesh<DeviceType> const &mesh,
+    Kokkos::View<unsigned int *, DeviceType> node_offset,
+    Kokkos::View<Coordinate **, DeviceType> physical_points,
+    Kokkos::View<int *, DeviceType> coarse_search_output_cells,
+    DTK_CellTopology cell_topo,
+    Kokkos::View<Coordinate **, DeviceType> reference_points,
+    Kokkos::View<bool *, DeviceType> point_in_cell, bool use_initial_guess )
+{
+    // Check the size of the Views
+    DTK_REQUIRE( reference_points.extent( 0 ) == point_in_cell.extent( 0 ) );
+    DTK_REQUIRE( reference_points.extent( 0 ) == physical_points.extent( 0 ) );
+    DTK_REQUIRE( reference_points.extent( 0 ) ==
+                 coarse_search_output_cells.extent( 0 ) );
+    DTK_REQUIRE( reference_points.extent( 1 ) == physical_points.extent( 1 ) );
+    DTK_REQUIRE( reference_points.extent( 1 ) ==
+                 mesh.nodes_coordinates.extent( 1 ) );
+    DTK_REQUIRE( node_offset.extent( 0 ) == mesh.cell_topologies.extent( 0 ) );
+
+    switch ( cell_topo )
+    {
+    case DTK_HEX_8:
+    {
+        internal::pointInMeshCell<HEX_8, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_HEX_27:
+    {
+        internal::pointInMeshCell<HEX_27, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_PYRAMID_5:
+    {
+        internal::pointInMeshCell<PYRAMID_5, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_QUAD_4:
+    {
+        internal::pointInMeshCell<QUAD_4, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_QUAD_9:
+    {
+        internal::pointInMeshCell<QUAD_9, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_TET_4:
+    {
+        internal::pointInMeshCell<TET_4, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_TET_10:
+    {
+        internal::pointInMeshCell<TET_10, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_TRI_3:
+    {
+        internal::pointInMeshCell<TRI_3, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_TRI_6:
+    {
+        internal::pointInMeshCell<TRI_6, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_WEDGE_6:
+    {
+        internal::pointInMeshCell<WEDGE_6, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
+        break;
+    }
+    case DTK_WEDGE_18:
+    {
+        internal::pointInMeshCell<WEDGE_18, DeviceType>(
+            threshold, rejection_threshold, mesh, node_offset,
+            physical_points, coarse_search_output_cells, reference_points,
+            point_in_cell, use_initial_guess );
         break;
     }
     default:
@@ -16,12 +16,14 @@
 #include <ArborX.hpp>
 #include <DTK_CellTypes.h>
 #include <DTK_Mesh.hpp>
+#include <DTK_SourceMeshIndex.hpp>
 
 #include <Kokkos_View.hpp>
 
 #include <mpi.h>
 
 #include <array>
+#include <memory>
 #include <tuple>
 
 namespace DataTransferKit
@@ -42,11 +44,35 @@ class PointSearch
      * @param mesh mesh of the domain of interest
      * @param points_coordinates coordinates in the physical frame of the points
      * that we are looking for.
+     * @param unique_results if true, a point found in several cells is only
+     * associated to one of them, see removeDuplicates().
+     * @param balance_queries if true, the points are redistributed among the
+     * processors along a space-filling curve before the search, see
+     * performDistributedSearch().
      * For a more detailed documentation on \p cell_topologies, \p
      * cells, and \p nodes_coordinates see the documentation of CellList.
      */
     PointSearch( MPI_Comm comm, Mesh<DeviceType> const &mesh,
-                 Kokkos::View<Coordinate **, DeviceType> points_coordinates );
+                 Kokkos::View<Coordinate **, DeviceType> points_coordinates,
+                 bool unique_results = false, bool balance_queries = false );
+
+    /**
+     * Constructor. The search of the points is done in the constructor but
+     * the results is not send back to the calling processor.
+     * @param source_mesh_index preprocessed mesh of the domain of interest. It
+     * can be shared with other PointSearch objects.
+     * @param points_coordinates coordinates in the physical frame of the points
+     * that we are looking for.
+     * @param unique_results if true, a point found in several cells is only
+     * associated to one of them, see removeDuplicates().
+     * @param balance_queries if true, the points are redistributed among the
+     * processors along a space-filling curve before the search, see
+     * performDistributedSearch().
+     */
+    PointSearch(
+        std::shared_ptr<SourceMeshIndex<DeviceType> const> source_mesh_index,
+        Kokkos::View<Coordinate **, DeviceType> points_coordinates,
+        bool unique_results = false, bool balance_queries = false );
 
     /**
      * Return the result of the search. The tuple contains the rank where the
@@ -59,9 +85,53 @@ class PointSearch
                Kokkos::View<unsigned int *, DeviceType>>
     getSearchResults() const;
 
+    /**
+     * Update the search after the points have moved. Each point is first
+     * searched in the cells where it was found previously, using the previous
+     * coordinates in the reference frame as initial guess. If the Newton
+     * solver does not converge from this guess, it starts again from the
+     * center of the cell as in the initial search. Only the points that are
+     * not found anymore in any of these cells are searched using the
+     * distributed tree. A point that is still found in one of its previous
+     * cells is not searched in the neighboring cells.
+     * @param points_coordinates new coordinates in the physical frame of the
+     * points given to the constructor.
+     */
+    void update( Kokkos::View<Coordinate **, DeviceType> points_coordinates );
+
+    /**
+     * Keep a single cell for the points that have been found in several
+     * cells, e.g., points on a vertex, an edge, or a face shared by several
+     * cells. The cell that is kept is the one with the lowest (rank, cell
+     * index) pair so the result does not depend on the order of the
+     * communications. The processors owning the points select the cells and
+     * the other results are removed by the processors owning the cells.
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
+    void removeDuplicates();
+
+    /**
+     * Build the communication pattern used by update() to send the new
+     * coordinates of the points to the processors owning the cells.
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
+    void buildUpdatePlan();
+
     /**
      * Perform the distributed search and sends the points and the cell indices
-     * to the processors owning the cells.
+     * to the processors owning the cells. If the queries are balanced, the
+     * points are first sorted by Morton code and split among the processors
+     * so that each processor searches a similar number of nearby points. The
+     * results keep the rank of the processor owning each point so that they
+     * are sent back to it. If the source mesh index uses k-DOPs, the
+     * candidates outside of the k-DOPs of the cells are removed by the
+     * processors owning the cells. If \p query_ids is not empty, it
+     * contains the query id associated to each point. Otherwise, the query id
+     * of a point is its index in \p points_coord.
      *
      * @note This function should be <b>private</b> but lambda functions can
      * only be called from a public function in CUDA.
@@ -71,7 +141,8 @@ class PointSearch
                Kokkos::View<int *, DeviceType>>
     performDistributedSearch(
         Kokkos::View<Coordinate **, DeviceType> points_coord,
-        Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes );
+        Kokkos::View<int *, DeviceType> query_ids =
+            Kokkos::View<int *, DeviceType>() );
 
     /**
      * Keep cell_indices, points, query_ids, and ranks that satisfy a given
@@ -85,9 +156,7 @@ class PointSearch
                Kokkos::View<int *, DeviceType>, Kokkos::View<int *, DeviceType>>
     filterTopology(
         Kokkos::View<unsigned int *, DeviceType> topo, unsigned int topo_id,
-        unsigned int size,
-        Kokkos::View<unsigned int **, DeviceType> bounding_box_to_cell,
-        Kokkos::View<int *, DeviceType> cell_indices,
+        unsigned int size, Kokkos::View<int *, DeviceType> cell_indices,
         Kokkos::View<ArborX::Point *, DeviceType> points,
         Kokkos::View<int *, DeviceType> query_ids,
         Kokkos::View<int *, DeviceType> ranks );
@@ -108,19 +177,11 @@ class PointSearch
         unsigned int topo_id );
 
   private:
-    /**
-     * Compute the number of cells associated to each topology.
-     */
-    std::array<unsigned int, DTK_N_TOPO> computeNCellsPerTopology(
-        Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies );
-
     /**
      * Compute the position in the reference frame of candidates found by the
      * search.
      */
     Kokkos::View<int *, DeviceType> performPointInCell(
-        Kokkos::View<Coordinate ***, DeviceType> cells,
-        Kokkos::View<unsigned int **, DeviceType> bounding_box_to_cell,
         Kokkos::View<int *, DeviceType> imported_cell_indices,
         Kokkos::View<ArborX::Point *, DeviceType> imported_points,
         Kokkos::View<int *, DeviceType> imported_query_ids,
@@ -137,14 +198,29 @@ class PointSearch
     template <typename T>
     friend class Interpolation;
 
+    std::shared_ptr<SourceMeshIndex<DeviceType> const> _source_mesh_index;
     MPI_Comm _comm;
     ArborX::Details::Distributor<DeviceType> _target_to_source_distributor;
     unsigned int _dim;
+    unsigned int _n_points;
+    bool _unique_results;
+    bool _balance_queries;
     std::array<Kokkos::View<Coordinate **, DeviceType>, DTK_N_TOPO>
         _reference_points;
     std::array<Kokkos::View<int *, DeviceType>, DTK_N_TOPO> _query_ids;
+    // Indices of the cells in the mesh (local IDs)
     std::array<Kokkos::View<int *, DeviceType>, DTK_N_TOPO> _cell_indices;
-    std::array<std::vector<unsigned int>, DTK_N_TOPO> _cell_indices_map;
+    // Rank of the processor that owns the point
+    std::array<Kokkos::View<int *, DeviceType>, DTK_N_TOPO> _ranks;
+
+    // Communication pattern used by update(). The new coordinates of the
+    // points _update_query_ids are sent using _source_to_target_distributor
+    // and the i-th coordinates received correspond to the reference point at
+    // position _update_positions(i).
+    bool _has_update_plan = false;
+    ArborX::Details::Distributor<DeviceType> _source_to_target_distributor;
+    Kokkos::View<int *, DeviceType> _update_query_ids;
+    Kokkos::View<int *, DeviceType> _update_positions;
 };
 } // namespace DataTransferKit
 
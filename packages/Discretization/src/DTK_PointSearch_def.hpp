@@ -21,40 +21,20 @@
 
 #include <mpi.h>
 
+#include <limits>
+#include <vector>
+
 namespace DataTransferKit
 {
 namespace internal
 {
 template <typename DeviceType>
-Kokkos::View<Coordinate **, DeviceType>
-convertPointDim( Kokkos::View<Coordinate **, DeviceType> points_coord_2d )
-{
-    DTK_REQUIRE( points_coord_2d.extent( 1 ) == 2 );
-
-    unsigned int const n_points = points_coord_2d.extent( 0 );
-    Kokkos::View<Coordinate **, DeviceType> points_coord_3d( "points_coord_3d",
-                                                             n_points, 3 );
-
-    using ExecutionSpace = typename DeviceType::execution_space;
-    Kokkos::parallel_for( DTK_MARK_REGION( "convert_2D_pts_to_3D_pts" ),
-                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
-                          KOKKOS_LAMBDA( int const i ) {
-                              points_coord_3d( i, 0 ) = points_coord_2d( i, 0 );
-                              points_coord_3d( i, 1 ) = points_coord_2d( i, 1 );
-                              points_coord_3d( i, 2 ) = 0.;
-                          } );
-    Kokkos::fence();
-
-    return points_coord_3d;
-}
-
-template <typename DeviceType>
-void buildTopo( Kokkos::View<int *, DeviceType> imported_cell_indices,
-                Kokkos::View<unsigned int **, DeviceType> bounding_box_to_cell,
-                Kokkos::View<unsigned int *, DeviceType> topo,
-                Kokkos::View<unsigned int[DTK_N_TOPO], DeviceType> topo_size )
+void buildTopo(
+    Kokkos::View<int *, DeviceType> imported_cell_indices,
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies,
+    Kokkos::View<unsigned int *, DeviceType> topo,
+    Kokkos::View<unsigned int[DTK_N_TOPO], DeviceType> topo_size )
 {
-    DTK_REQUIRE( bounding_box_to_cell.extent( 1 ) == DTK_N_TOPO );
     DTK_REQUIRE( topo.extent( 0 ) == imported_cell_indices.extent( 0 ) );
 
     unsigned int const n_imports = imported_cell_indices.extent( 0 );
@@ -63,16 +43,10 @@ void buildTopo( Kokkos::View<int *, DeviceType> imported_cell_indices,
         DTK_MARK_REGION( "build_topo" ),
         Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
         KOKKOS_LAMBDA( int const i ) {
-            for ( unsigned int j = 0; j < DTK_N_TOPO; ++j )
-            {
-                if ( bounding_box_to_cell( imported_cell_indices( i ), j ) !=
-                     static_cast<unsigned int>( -1 ) )
-                {
-                    topo( i ) = j;
-                    Kokkos::atomic_increment( &topo_size( j ) );
-                    break;
-                }
-            }
+            unsigned int const topo_id =
+                cell_topologies( imported_cell_indices( i ) );
+            topo( i ) = topo_id;
+            Kokkos::atomic_increment( &topo_size( topo_id ) );
         } );
     Kokkos::fence();
 
@@ -115,7 +89,9 @@ moveDataFromSourceToTarget(
     MPI_Comm comm, Kokkos::View<int *, DeviceType> indices,
     Kokkos::View<int *, DeviceType> offset,
     Kokkos::View<int *, DeviceType> ranks,
-    Kokkos::View<Coordinate **, DeviceType> points_coord, unsigned int dim )
+    Kokkos::View<Coordinate **, DeviceType> points_coord,
+    Kokkos::View<int *, DeviceType> query_ids,
+    Kokkos::View<int *, DeviceType> query_ranks, unsigned int dim )
 {
     using ExecutionSpace = typename DeviceType::execution_space;
 
@@ -134,25 +110,28 @@ moveDataFromSourceToTarget(
         "exported_points", indices_size );
     Kokkos::View<int *, DeviceType> exported_query_ids( "exported_query_ids",
                                                         indices_size );
+    Kokkos::View<int *, DeviceType> exported_ranks( "exported_ranks",
+                                                    indices_size );
+    bool const use_query_ids = ( query_ids.extent( 0 ) != 0 );
+    bool const use_query_ranks = ( query_ranks.extent( 0 ) != 0 );
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
     Kokkos::parallel_for(
         "duplicate_points",
         Kokkos::RangePolicy<ExecutionSpace>( 0, offset.extent( 0 ) - 1 ),
         KOKKOS_LAMBDA( int const i ) {
             for ( int j = offset( i ); j < offset( i + 1 ); ++j )
             {
-                exported_query_ids( j ) = i;
-                for ( unsigned int k = 0; k < dim; ++k )
-                    exported_points( j )[k] = points_coord( i, k );
+                exported_query_ids( j ) = use_query_ids ? query_ids( i ) : i;
+                exported_ranks( j ) =
+                    use_query_ranks ? query_ranks( i ) : comm_rank;
+                for ( unsigned int k = 0; k < 3; ++k )
+                    exported_points( j )[k] =
+                        ( k < dim ) ? points_coord( i, k ) : 0.;
             }
         } );
     Kokkos::fence();
 
-    Kokkos::View<int *, DeviceType> exported_ranks( "exported_ranks",
-                                                    indices_size );
-    int comm_rank;
-    MPI_Comm_rank( comm, &comm_rank );
-    Kokkos::deep_copy( exported_ranks, comm_rank );
-
     Kokkos::View<ArborX::Point *, DeviceType> imported_points(
         "imported_points", n_imports );
     Kokkos::View<int *, DeviceType> imported_cell_indices( "imported_indices",
@@ -171,50 +150,455 @@ moveDataFromSourceToTarget(
     return std::make_tuple( imported_points, imported_cell_indices,
                             imported_query_ids, imported_ranks );
 }
-} // namespace internal
 
+// Remove the candidates whose point is outside of the k-DOP of the cell. This
+// is done by the processors owning the cells, before the PointInCell search.
 template <typename DeviceType>
-PointSearch<DeviceType>::PointSearch(
-    MPI_Comm comm, Mesh<DeviceType> const &mesh,
-    Kokkos::View<Coordinate **, DeviceType> points_coordinates )
-    : _comm( comm )
-    , _target_to_source_distributor( _comm )
+std::tuple<Kokkos::View<ArborX::Point *, DeviceType>,
+           Kokkos::View<int *, DeviceType>, Kokkos::View<int *, DeviceType>,
+           Kokkos::View<int *, DeviceType>>
+filterKDOPs( Kokkos::View<Coordinate **, DeviceType> kdops,
+             Kokkos::View<ArborX::Point *, DeviceType> points,
+             Kokkos::View<int *, DeviceType> cell_indices,
+             Kokkos::View<int *, DeviceType> query_ids,
+             Kokkos::View<int *, DeviceType> ranks )
 {
-    DTK_REQUIRE( points_coordinates.extent( 1 ) ==
-                 mesh.nodes_coordinates.extent( 1 ) );
-    _dim = points_coordinates.extent( 1 );
+    using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int constexpr n_directions =
+        Discretization::Helpers::n_kdop_directions;
+    unsigned int const n_candidates = points.extent( 0 );
+    Kokkos::View<unsigned int *, DeviceType> in_kdop( "in_kdop",
+                                                      n_candidates );
+    unsigned int n_kept = 0;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "check_kdops" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_candidates ),
+        KOKKOS_LAMBDA( int const i, unsigned int &partial_sum ) {
+            int const cell = cell_indices( i );
+            double const x[3] = {points( i )[0], points( i )[1],
+                                 points( i )[2]};
+            in_kdop( i ) = 1;
+            for ( unsigned int k = 0; k < n_directions; ++k )
+            {
+                double const projection =
+                    Discretization::Helpers::projectOnKDOPDirection( k, x );
+                if ( ( projection < kdops( cell, k ) ) ||
+                     ( projection > kdops( cell, n_directions + k ) ) )
+                {
+                    in_kdop( i ) = 0;
+                    break;
+                }
+            }
+            partial_sum += in_kdop( i );
+        },
+        n_kept );
+    if ( n_kept == n_candidates )
+        return std::make_tuple( points, cell_indices, query_ids, ranks );
+
+    Kokkos::View<unsigned int *, DeviceType> offset( "offset", n_candidates );
+    Discretization::Helpers::computeOffset( in_kdop, 1u, offset );
+    Kokkos::View<ArborX::Point *, DeviceType> kept_points( points.label(),
+                                                           n_kept );
+    Kokkos::View<int *, DeviceType> kept_cell_indices( cell_indices.label(),
+                                                       n_kept );
+    Kokkos::View<int *, DeviceType> kept_query_ids( query_ids.label(),
+                                                    n_kept );
+    Kokkos::View<int *, DeviceType> kept_ranks( ranks.label(), n_kept );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "filter_kdops" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_candidates ),
+        KOKKOS_LAMBDA( int const i ) {
+            if ( in_kdop( i ) == 1 )
+            {
+                unsigned int const k = offset( i );
+                kept_points( k ) = points( i );
+                kept_cell_indices( k ) = cell_indices( i );
+                kept_query_ids( k ) = query_ids( i );
+                kept_ranks( k ) = ranks( i );
+            }
+        } );
+    Kokkos::fence();
+
+    return std::make_tuple( kept_points, kept_cell_indices, kept_query_ids,
+                            kept_ranks );
+}
+
+// Return a View containing the values of first followed by the values of
+// second.
+template <typename ViewType>
+ViewType concatenate( ViewType first, ViewType second )
+{
+    static_assert( ViewType::rank == 1 || ViewType::rank == 2,
+                   "concatenate() requires rank-1 or rank-2 view arguments" );
+
+    using ExecutionSpace = typename ViewType::execution_space;
+    int const n_first = first.extent( 0 );
+    int const n_second = second.extent( 0 );
+    if ( n_first == 0 )
+        return second;
+    if ( n_second == 0 )
+        return first;
+
+    int const n_components = first.extent( 1 );
+    DTK_REQUIRE( second.extent( 1 ) == first.extent( 1 ) );
+    auto both = ViewType::rank == 1
+                    ? ViewType( first.label(), n_first + n_second )
+                    : ViewType( first.label(), n_first + n_second,
+                                n_components );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "concatenate" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_first + n_second ),
+        KOKKOS_LAMBDA( int const i ) {
+            for ( int j = 0; j < n_components; ++j )
+                both.access( i, j ) = ( i < n_first )
+                                          ? first.access( i, j )
+                                          : second.access( i - n_first, j );
+        } );
+    Kokkos::fence();
+
+    return both;
+}
+
+// Spread the bits of a 10-bit integer so that there are two zeros between
+// each bit.
+KOKKOS_INLINE_FUNCTION
+unsigned int expandBits( unsigned int v )
+{
+    v = ( v * 0x00010001u ) & 0xFF0000FFu;
+    v = ( v * 0x00000101u ) & 0x0F00F00Fu;
+    v = ( v * 0x00000011u ) & 0xC30C30C3u;
+    v = ( v * 0x00000005u ) & 0x49249249u;
+    return v;
+}
+
+// Compute the 30-bit Morton code of a point given its coordinates scaled to
+// [0, 1].
+KOKKOS_INLINE_FUNCTION
+unsigned int mortonCode( double const x[3] )
+{
+    unsigned int code = 0;
+    for ( unsigned int d = 0; d < 3; ++d )
+    {
+        double const xd = x[d] * 1024.;
+        unsigned int const v =
+            xd < 0. ? 0u
+                    : ( xd > 1023. ? 1023u : static_cast<unsigned int>( xd ) );
+        code += expandBits( v ) << ( 2 - d );
+    }
+    return code;
+}
+
+// Return the number of entries of the sorted codes smaller than code, or
+// smaller than or equal to code if inclusive is true.
+template <typename View>
+KOKKOS_INLINE_FUNCTION long long
+countSortedCodes( View const &sorted_codes, unsigned int const code,
+                  bool const inclusive )
+{
+    int first = 0;
+    int last = sorted_codes.extent( 0 );
+    while ( first < last )
+    {
+        int const middle = first + ( last - first ) / 2;
+        if ( ( sorted_codes( middle ) < code ) ||
+             ( inclusive && ( sorted_codes( middle ) == code ) ) )
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return first;
+}
+
+// Redistribute the points among the processors before the search. The Morton
+// codes of the points are computed in the bounding box of all the points and
+// the points are ordered along the curve, the ties being broken by the rank
+// and the local index of the points. A point at the global position pos in
+// this order is sent to the processor pos * comm_size / n_total_points so
+// that every processor searches the same number of nearby points, even if the
+// points are clustered. The received points are sorted by Morton code. The
+// query id and the rank of the processor owning each point are sent along
+// with the coordinates so that the results can be sent back to the owner.
+template <typename DeviceType>
+std::tuple<Kokkos::View<Coordinate **, DeviceType>,
+           Kokkos::View<int *, DeviceType>, Kokkos::View<int *, DeviceType>>
+balanceQueries( MPI_Comm comm,
+                Kokkos::View<Coordinate **, DeviceType> points_coord,
+                Kokkos::View<int *, DeviceType> query_ids )
+{
+    DTK_REQUIRE( ( points_coord.extent( 1 ) == 2 ) ||
+                 ( points_coord.extent( 1 ) == 3 ) );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+    ExecutionSpace space;
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+    int comm_size;
+    MPI_Comm_size( comm, &comm_size );
+    unsigned int const n_points = points_coord.extent( 0 );
+    unsigned int const dim = points_coord.extent( 1 );
 
-    // Compute the number of cells of each of the supported topologies.
-    std::array<unsigned int, DTK_N_TOPO> n_cells_per_topo =
-        Discretization::Helpers::computeNCellsPerTopology(
-            mesh.cell_topologies );
-
-    // Compute the topology and node offset
-    Discretization::Helpers::MeshOffsets<DeviceType> mesh_offsets( mesh );
-
-    // Convert the cells and cell_nodes_coordinates View to block_cells
-    auto n_nodes_per_topo_host =
-        Kokkos::create_mirror_view( mesh_offsets.n_nodes_per_topo );
-    Kokkos::deep_copy( n_nodes_per_topo_host, mesh_offsets.n_nodes_per_topo );
-    std::array<Kokkos::View<Coordinate ***, DeviceType>, DTK_N_TOPO>
-        block_cells;
-    for ( int i = 0; i < DTK_N_TOPO; ++i )
+    // Compute the bounding box of all the points. In 2D, the points are in
+    // the z = 0 plane.
+    double local_min[3] = {0., 0., 0.};
+    double local_max[3] = {0., 0., 0.};
+    for ( unsigned int d = 0; d < dim; ++d )
     {
-        block_cells[i] = Kokkos::View<Coordinate ***, DeviceType>(
-            "block_cells_" + std::to_string( i ), n_cells_per_topo[i],
-            n_nodes_per_topo_host( i ), _dim );
+        Kokkos::parallel_reduce(
+            DTK_MARK_REGION( "compute_min_coordinate" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+            KOKKOS_LAMBDA( int const i, double &partial_min ) {
+                if ( points_coord( i, d ) < partial_min )
+                    partial_min = points_coord( i, d );
+            },
+            Kokkos::Min<double>( local_min[d] ) );
+        Kokkos::parallel_reduce(
+            DTK_MARK_REGION( "compute_max_coordinate" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+            KOKKOS_LAMBDA( int const i, double &partial_max ) {
+                if ( points_coord( i, d ) > partial_max )
+                    partial_max = points_coord( i, d );
+            },
+            Kokkos::Max<double>( local_max[d] ) );
+    }
+    Kokkos::Array<double, 3> global_min;
+    Kokkos::Array<double, 3> global_max;
+    MPI_Allreduce( local_min, global_min.data(), 3, MPI_DOUBLE, MPI_MIN,
+                   comm );
+    MPI_Allreduce( local_max, global_max.data(), 3, MPI_DOUBLE, MPI_MAX,
+                   comm );
+    Kokkos::Array<double, 3> scaling;
+    for ( unsigned int d = 0; d < 3; ++d )
+        scaling[d] = ( global_max[d] > global_min[d] )
+                         ? 1. / ( global_max[d] - global_min[d] )
+                         : 0.;
+
+    // Compute the Morton codes
+    Kokkos::View<unsigned int *, DeviceType> codes( "morton_codes", n_points );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "compute_morton_codes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int const i ) {
+            double x[3] = {0., 0., 0.};
+            for ( unsigned int d = 0; d < dim; ++d )
+                x[d] = ( points_coord( i, d ) - global_min[d] ) * scaling[d];
+            codes( i ) = mortonCode( x );
+        } );
+    Kokkos::fence();
+    // Sort a copy of the codes to count the points below the splitters. The
+    // permutation gives the position of each point in the local order along
+    // the curve.
+    Kokkos::View<unsigned int *, DeviceType> sorted_codes(
+        Kokkos::ViewAllocateWithoutInitializing( "sorted_codes" ), n_points );
+    Kokkos::deep_copy( sorted_codes, codes );
+    decltype( ArborX::Details::sortObjects( space, sorted_codes ) )
+        sort_permutation;
+    if ( n_points > 0 )
+        sort_permutation = ArborX::Details::sortObjects( space, sorted_codes );
+    long long n_total_points = n_points;
+    MPI_Allreduce( MPI_IN_PLACE, &n_total_points, 1, MPI_LONG_LONG, MPI_SUM,
+                   comm );
+
+    // Processor k + 1 starts at the global position first_positions[k]. Find
+    // the code of the point at this position, i.e. the smallest code such
+    // that more than first_positions[k] points have a smaller or equal code,
+    // by bisection over the 30-bit codes. All the splitters are searched at
+    // once so each step requires a single reduction.
+    int const n_splitters = comm_size - 1;
+    Kokkos::View<long long *, DeviceType> first_positions( "first_positions",
+                                                           n_splitters );
+    auto first_positions_host = Kokkos::create_mirror_view( first_positions );
+    for ( int k = 0; k < n_splitters; ++k )
+        first_positions_host( k ) =
+            ( ( k + 1 ) * n_total_points + comm_size - 1 ) / comm_size;
+    Kokkos::deep_copy( first_positions, first_positions_host );
+    Kokkos::View<unsigned int *, DeviceType> splitters( "splitters",
+                                                        n_splitters );
+    auto splitters_host = Kokkos::create_mirror_view( splitters );
+    Kokkos::View<long long *, DeviceType> counts( "counts", n_splitters );
+    auto counts_host = Kokkos::create_mirror_view( counts );
+    std::vector<unsigned int> lower( n_splitters, 0 );
+    std::vector<unsigned int> upper( n_splitters, ( 1u << 30 ) - 1 );
+    for ( unsigned int step = 0; step < 30; ++step )
+    {
+        for ( int k = 0; k < n_splitters; ++k )
+            splitters_host( k ) = lower[k] + ( upper[k] - lower[k] ) / 2;
+        Kokkos::deep_copy( splitters, splitters_host );
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "count_codes_below_splitters" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_splitters ),
+            KOKKOS_LAMBDA( int const k ) {
+                counts( k ) = countSortedCodes( sorted_codes, splitters( k ),
+                                                true );
+            } );
+        Kokkos::deep_copy( counts_host, counts );
+        MPI_Allreduce( MPI_IN_PLACE, counts_host.data(), n_splitters,
+                       MPI_LONG_LONG, MPI_SUM, comm );
+        for ( int k = 0; k < n_splitters; ++k )
+        {
+            if ( counts_host( k ) > first_positions_host( k ) )
+                upper[k] = splitters_host( k );
+            else
+                lower[k] = splitters_host( k ) + 1;
+        }
     }
-    Discretization::Helpers::convertMesh( mesh, mesh_offsets, block_cells );
+    // There is no point left for the last processors if there are fewer
+    // points than processors.
+    for ( int k = 0; k < n_splitters; ++k )
+        splitters_host( k ) = ( first_positions_host( k ) < n_total_points )
+                                  ? lower[k]
+                                  : std::numeric_limits<unsigned int>::max();
+    Kokkos::deep_copy( splitters, splitters_host );
+
+    // The points whose code is a splitter are split using their exact global
+    // position: the number of points with a smaller code, plus the number of
+    // points with the same code on the previous processors, plus their local
+    // position among the points with the same code.
+    Kokkos::View<long long *, DeviceType> n_local_less( "n_local_less",
+                                                        n_splitters );
+    Kokkos::View<long long *, DeviceType> n_local_equal( "n_local_equal",
+                                                         n_splitters );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "count_codes_equal_to_splitters" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_splitters ),
+        KOKKOS_LAMBDA( int const k ) {
+            n_local_less( k ) =
+                countSortedCodes( sorted_codes, splitters( k ), false );
+            n_local_equal( k ) =
+                countSortedCodes( sorted_codes, splitters( k ), true ) -
+                n_local_less( k );
+        } );
+    Kokkos::View<long long *, DeviceType> n_less( "n_less", n_splitters );
+    Kokkos::View<long long *, DeviceType> n_previous_equal( "n_previous_equal",
+                                                            n_splitters );
+    auto n_less_host = Kokkos::create_mirror_view_and_copy(
+        Kokkos::HostSpace{}, n_local_less );
+    auto n_previous_equal_host = Kokkos::create_mirror_view_and_copy(
+        Kokkos::HostSpace{}, n_local_equal );
+    MPI_Allreduce( MPI_IN_PLACE, n_less_host.data(), n_splitters,
+                   MPI_LONG_LONG, MPI_SUM, comm );
+    MPI_Exscan( MPI_IN_PLACE, n_previous_equal_host.data(), n_splitters,
+                MPI_LONG_LONG, MPI_SUM, comm );
+    if ( comm_rank == 0 )
+        Kokkos::deep_copy( n_previous_equal_host, 0 );
+    Kokkos::deep_copy( n_less, n_less_host );
+    Kokkos::deep_copy( n_previous_equal, n_previous_equal_host );
+
+    Kokkos::View<int *, DeviceType> destination_ranks( "destination_ranks",
+                                                       n_points );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "compute_destination_ranks" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int const i ) {
+            unsigned int const code = sorted_codes( i );
+            // Number of splitters smaller than the code
+            int first_splitter = 0;
+            int last_splitter = n_splitters;
+            while ( first_splitter < last_splitter )
+            {
+                int const middle =
+                    first_splitter + ( last_splitter - first_splitter ) / 2;
+                if ( splitters( middle ) < code )
+                    first_splitter = middle + 1;
+                else
+                    last_splitter = middle;
+            }
+            int rank = first_splitter;
+            if ( ( first_splitter < n_splitters ) &&
+                 ( splitters( first_splitter ) == code ) )
+            {
+                long long const position =
+                    n_less( first_splitter ) +
+                    n_previous_equal( first_splitter ) + i -
+                    n_local_less( first_splitter );
+                for ( int k = first_splitter;
+                      ( k < n_splitters ) && ( splitters( k ) == code ); ++k )
+                    if ( position >= first_positions( k ) )
+                        rank = k + 1;
+            }
+            destination_ranks( sort_permutation( i ) ) = rank;
+        } );
+    Kokkos::fence();
 
-    // Initialize bounding_box_to_cell to an invalid state
-    Kokkos::View<unsigned int **, DeviceType> bounding_box_to_cell(
-        "bounding_box_to_cell", mesh.cell_topologies.extent( 0 ), DTK_N_TOPO );
-    Kokkos::deep_copy( bounding_box_to_cell, static_cast<unsigned int>( -1 ) );
+    // Send the points to their processors
+    Kokkos::View<int *, DeviceType> exported_query_ids( "exported_query_ids",
+                                                        n_points );
+    Kokkos::View<int *, DeviceType> exported_ranks( "exported_ranks",
+                                                    n_points );
+    bool const use_query_ids = ( query_ids.extent( 0 ) != 0 );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "export_query_ids" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int const i ) {
+            exported_query_ids( i ) = use_query_ids ? query_ids( i ) : i;
+            exported_ranks( i ) = comm_rank;
+        } );
+    Kokkos::fence();
+    ArborX::Details::Distributor<DeviceType> distributor( comm );
+    unsigned int const n_imports =
+        distributor.createFromSends( space, destination_ranks );
+    Kokkos::View<Coordinate **, DeviceType> imported_points( "imported_points",
+                                                             n_imports, dim );
+    Kokkos::View<unsigned int *, DeviceType> imported_codes( "imported_codes",
+                                                             n_imports );
+    Kokkos::View<int *, DeviceType> imported_query_ids( "imported_query_ids",
+                                                        n_imports );
+    Kokkos::View<int *, DeviceType> imported_ranks( "imported_ranks",
+                                                    n_imports );
+    sendDataAcrossNetwork(
+        distributor, std::make_pair( points_coord, imported_points ),
+        std::make_pair( codes, imported_codes ),
+        std::make_pair( exported_query_ids, imported_query_ids ),
+        std::make_pair( exported_ranks, imported_ranks ) );
 
-    Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes(
-        "bounding_boxes", mesh.cell_topologies.extent( 0 ) );
-    Discretization::Helpers::createBoundingBoxes(
-        mesh, mesh_offsets, block_cells, bounding_boxes, bounding_box_to_cell );
+    // Sort the points along the space-filling curve so that neighboring
+    // queries traverse the same branches of the tree
+    Kokkos::View<int *, DeviceType> permutation( "permutation", n_imports );
+    ArborX::iota( space, permutation );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sortResults(
+        space, imported_codes, permutation, imported_query_ids,
+        imported_ranks );
+    Kokkos::View<Coordinate **, DeviceType> sorted_points( "sorted_points",
+                                                           n_imports, dim );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "permute_points" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
+        KOKKOS_LAMBDA( int const i ) {
+            for ( unsigned int d = 0; d < dim; ++d )
+                sorted_points( i, d ) = imported_points( permutation( i ), d );
+        } );
+    Kokkos::fence();
+
+    return std::make_tuple( sorted_points, imported_query_ids,
+                            imported_ranks );
+}
+} // namespace internal
+
+template <typename DeviceType>
+PointSearch<DeviceType>::PointSearch(
+    MPI_Comm comm, Mesh<DeviceType> const &mesh,
+    Kokkos::View<Coordinate **, DeviceType> points_coordinates,
+    bool unique_results, bool balance_queries )
+    : PointSearch( std::make_shared<SourceMeshIndex<DeviceType> const>( comm,
+                                                                       mesh ),
+                   points_coordinates, unique_results, balance_queries )
+{
+}
+
+template <typename DeviceType>
+PointSearch<DeviceType>::PointSearch(
+    std::shared_ptr<SourceMeshIndex<DeviceType> const> source_mesh_index,
+    Kokkos::View<Coordinate **, DeviceType> points_coordinates,
+    bool unique_results, bool balance_queries )
+    : _source_mesh_index( source_mesh_index )
+    , _comm( source_mesh_index->_comm )
+    , _target_to_source_distributor( _comm )
+    , _unique_results( unique_results )
+    , _balance_queries( balance_queries )
+    , _source_to_target_distributor( _comm )
+{
+    DTK_REQUIRE( points_coordinates.extent( 1 ) == _source_mesh_index->_dim );
+    _dim = points_coordinates.extent( 1 );
+    _n_points = points_coordinates.extent( 0 );
 
     // Perform the distributed search. At the end of the distributed search the
     // points are moved from the "source processors" to the "target processors".
@@ -225,10 +609,7 @@ PointSearch<DeviceType>::PointSearch(
     Kokkos::View<int *, DeviceType> imported_ranks;
     std::tie( imported_points, imported_cell_indices, imported_query_ids,
               imported_ranks ) =
-        performDistributedSearch(
-            ( _dim == 3 ) ? points_coordinates
-                          : internal::convertPointDim( points_coordinates ),
-            bounding_boxes );
+        performDistributedSearch( points_coordinates );
 
     // We need to separate the data for the different topologies because of
     // Intrepid2. Because a point can be found in multiple cells, we need to
@@ -236,33 +617,399 @@ PointSearch<DeviceType>::PointSearch(
     unsigned int const n_imports = imported_points.extent( 0 );
     Kokkos::View<unsigned int *, DeviceType> topo( "topo", n_imports );
     Kokkos::View<unsigned int[DTK_N_TOPO], DeviceType> topo_size( "topo_size" );
-    internal::buildTopo( imported_cell_indices, bounding_box_to_cell, topo,
+    internal::buildTopo( imported_cell_indices,
+                         _source_mesh_index->_mesh.cell_topologies, topo,
                          topo_size );
     auto topo_size_host = Kokkos::create_mirror_view( topo_size );
     Kokkos::deep_copy( topo_size_host, topo_size );
 
-    std::array<Kokkos::View<int *, DeviceType>, DTK_N_TOPO> filtered_ranks;
     // Check if the points are in the cells
     for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
-        if ( block_cells[topo_id].extent( 0 ) != 0 )
+        if ( topo_size_host( topo_id ) != 0 )
         {
-            filtered_ranks[topo_id] = performPointInCell(
-                block_cells[topo_id], bounding_box_to_cell,
+            _ranks[topo_id] = performPointInCell(
                 imported_cell_indices, imported_points, imported_query_ids,
                 imported_ranks, topo, topo_id, topo_size_host( topo_id ) );
         }
 
     // Build the _source_to_target_distributor
-    build_distributor( filtered_ranks );
-
-    // Build a map between the cell_indices sorted by topology and the flat View
-    // given to the constructor
-    auto cell_topologies_host =
-        Kokkos::create_mirror_view( mesh.cell_topologies );
-    Kokkos::deep_copy( cell_topologies_host, mesh.cell_topologies );
-    unsigned int const size = cell_topologies_host.extent( 0 );
-    for ( unsigned int i = 0; i < size; ++i )
-        _cell_indices_map[cell_topologies_host( i )].push_back( i );
+    build_distributor( _ranks );
+
+    if ( _unique_results )
+        removeDuplicates();
+}
+
+template <typename DeviceType>
+void PointSearch<DeviceType>::removeDuplicates()
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    ExecutionSpace space;
+
+    // The communication pattern of update() is used to send data back and
+    // forth between the processors owning the points and the processors
+    // owning the cells.
+    if ( !_has_update_plan )
+        buildUpdatePlan();
+
+    // Send the rank and the cell index associated to each reference point to
+    // the processors owning the points. The pair is encoded in a single key.
+    unsigned int n_ref_pts = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+        n_ref_pts += _query_ids[topo_id].extent( 0 );
+    int comm_rank;
+    MPI_Comm_rank( _comm, &comm_rank );
+    long long const rank_key = static_cast<long long>( comm_rank ) << 32;
+    Kokkos::View<long long *, DeviceType> keys( "keys", n_ref_pts );
+    unsigned int n_copied_pts = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+    {
+        unsigned int const size = _query_ids[topo_id].extent( 0 );
+        auto topo_cell_indices = _cell_indices[topo_id];
+        Kokkos::parallel_for( DTK_MARK_REGION( "fill_keys" ),
+                              Kokkos::RangePolicy<ExecutionSpace>( 0, size ),
+                              KOKKOS_LAMBDA( int const i ) {
+                                  keys( i + n_copied_pts ) =
+                                      rank_key + topo_cell_indices( i );
+                              } );
+        Kokkos::fence();
+
+        n_copied_pts += size;
+    }
+    unsigned int const n_exports = _update_query_ids.extent( 0 );
+    Kokkos::View<long long *, DeviceType> imported_keys( "imported_keys",
+                                                         n_exports );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _target_to_source_distributor, keys, imported_keys );
+
+    // Select the smallest key of each point
+    Kokkos::View<long long *, DeviceType> min_keys( "min_keys", _n_points );
+    Kokkos::deep_copy( min_keys, std::numeric_limits<long long>::max() );
+    auto update_query_ids = _update_query_ids;
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "compute_min_keys" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_exports ),
+        KOKKOS_LAMBDA( int const i ) {
+            Kokkos::atomic_fetch_min( &min_keys( update_query_ids( i ) ),
+                                      imported_keys( i ) );
+        } );
+    Kokkos::fence();
+    Kokkos::View<int *, DeviceType> keep( "keep", n_exports );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "select_cells" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_exports ),
+        KOKKOS_LAMBDA( int const i ) {
+            keep( i ) =
+                ( imported_keys( i ) == min_keys( update_query_ids( i ) ) ) ? 1
+                                                                            : 0;
+        } );
+    Kokkos::fence();
+
+    // Send the selection back to the processors owning the cells
+    Kokkos::View<int *, DeviceType> imported_keep( "imported_keep", n_ref_pts );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _source_to_target_distributor, keep, imported_keep );
+    Kokkos::View<bool *, DeviceType> kept( "kept", n_ref_pts );
+    auto update_positions = _update_positions;
+    Kokkos::parallel_for( DTK_MARK_REGION( "unpack_keep" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_ref_pts ),
+                          KOKKOS_LAMBDA( int const i ) {
+                              kept( update_positions( i ) ) =
+                                  ( imported_keep( i ) == 1 );
+                          } );
+    Kokkos::fence();
+
+    // Remove the duplicates
+    unsigned int offset = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+    {
+        unsigned int const size = _query_ids[topo_id].extent( 0 );
+        if ( size == 0 )
+            continue;
+
+        Kokkos::View<bool *, DeviceType> topo_kept(
+            "topo_kept_" + std::to_string( topo_id ), size );
+        Kokkos::parallel_for( DTK_MARK_REGION( "fill_topo_kept" ),
+                              Kokkos::RangePolicy<ExecutionSpace>( 0, size ),
+                              KOKKOS_LAMBDA( int const i ) {
+                                  topo_kept( i ) = kept( offset + i );
+                              } );
+        Kokkos::fence();
+
+        _ranks[topo_id] = filterInCell(
+            topo_kept, _reference_points[topo_id], _cell_indices[topo_id],
+            _query_ids[topo_id], _ranks[topo_id], topo_id );
+
+        offset += size;
+    }
+
+    build_distributor( _ranks );
+    _has_update_plan = false;
+}
+
+template <typename DeviceType>
+void PointSearch<DeviceType>::buildUpdatePlan()
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    ExecutionSpace space;
+
+    // Send the query ids and the positions of the reference points to the
+    // processors that own the points.
+    unsigned int n_ref_pts = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+        n_ref_pts += _query_ids[topo_id].extent( 0 );
+    Kokkos::View<int *, DeviceType> query_ids( "query_ids", n_ref_pts );
+    unsigned int n_copied_pts = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+    {
+        unsigned int const size = _query_ids[topo_id].extent( 0 );
+        auto topo_query_ids = _query_ids[topo_id];
+        Kokkos::parallel_for( DTK_MARK_REGION( "query_ids" ),
+                              Kokkos::RangePolicy<ExecutionSpace>( 0, size ),
+                              KOKKOS_LAMBDA( int const i ) {
+                                  query_ids( i + n_copied_pts ) =
+                                      topo_query_ids( i );
+                              } );
+        Kokkos::fence();
+
+        n_copied_pts += size;
+    }
+    Kokkos::View<int *, DeviceType> positions( "positions", n_ref_pts );
+    ArborX::iota( space, positions );
+    Kokkos::View<int *, DeviceType> ranks( "ranks", n_ref_pts );
+    int comm_rank;
+    MPI_Comm_rank( _comm, &comm_rank );
+    Kokkos::deep_copy( ranks, comm_rank );
+
+    unsigned int const n_imports =
+        _target_to_source_distributor.getTotalReceiveLength();
+    Kokkos::View<int *, DeviceType> imported_query_ids( "imported_query_ids",
+                                                        n_imports );
+    Kokkos::View<int *, DeviceType> imported_positions( "imported_positions",
+                                                        n_imports );
+    Kokkos::View<int *, DeviceType> imported_ranks( "imported_ranks",
+                                                    n_imports );
+    internal::sendDataAcrossNetwork(
+        _target_to_source_distributor,
+        std::make_pair( query_ids, imported_query_ids ),
+        std::make_pair( positions, imported_positions ),
+        std::make_pair( ranks, imported_ranks ) );
+
+    // Build the distributor used to send the coordinates back to the
+    // processors owning the cells. The positions are sent only once so that
+    // the coordinates can be put in the right place when they are received.
+    auto imported_ranks_host = Kokkos::create_mirror_view( imported_ranks );
+    Kokkos::deep_copy( imported_ranks_host, imported_ranks );
+    unsigned int const n_positions =
+        _source_to_target_distributor.createFromSends( space,
+                                                       imported_ranks_host );
+    DTK_CHECK( n_positions == n_ref_pts );
+    _update_query_ids = imported_query_ids;
+    _update_positions =
+        Kokkos::View<int *, DeviceType>( "update_positions", n_positions );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _source_to_target_distributor, imported_positions,
+        _update_positions );
+
+    _has_update_plan = true;
+}
+
+template <typename DeviceType>
+void PointSearch<DeviceType>::update(
+    Kokkos::View<Coordinate **, DeviceType> points_coordinates )
+{
+    DTK_REQUIRE( points_coordinates.extent( 0 ) == _n_points );
+    DTK_REQUIRE( points_coordinates.extent( 1 ) == _dim );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+    ExecutionSpace space;
+
+    if ( !_has_update_plan )
+        buildUpdatePlan();
+
+    // Send the new coordinates of the points to the processors owning the
+    // cells where the points were found.
+    unsigned int const dim = _dim;
+    unsigned int const n_exports = _update_query_ids.extent( 0 );
+    Kokkos::View<Coordinate **, DeviceType> exported_points( "exported_points",
+                                                             n_exports, dim );
+    auto update_query_ids = _update_query_ids;
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "pack_points" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_exports ),
+        KOKKOS_LAMBDA( int const i ) {
+            for ( unsigned int d = 0; d < dim; ++d )
+                exported_points( i, d ) =
+                    points_coordinates( update_query_ids( i ), d );
+        } );
+    Kokkos::fence();
+
+    unsigned int const n_ref_pts = _update_positions.extent( 0 );
+    Kokkos::View<Coordinate **, DeviceType> imported_points( "imported_points",
+                                                             n_ref_pts, dim );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _source_to_target_distributor, exported_points,
+        imported_points );
+    Kokkos::View<Coordinate **, DeviceType> moved_points( "moved_points",
+                                                          n_ref_pts, dim );
+    auto update_positions = _update_positions;
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "unpack_points" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_ref_pts ),
+        KOKKOS_LAMBDA( int const i ) {
+            for ( unsigned int d = 0; d < dim; ++d )
+                moved_points( update_positions( i ), d ) =
+                    imported_points( i, d );
+        } );
+    Kokkos::fence();
+
+    // Check if the points are still in the cells where they were found. The
+    // previous coordinates in the reference frame are used as initial guess.
+    auto const &mesh = _source_mesh_index->_mesh;
+    auto node_offset = _source_mesh_index->_node_offset;
+    Topologies topologies;
+    Kokkos::View<int *, DeviceType> found( "found", n_ref_pts );
+    unsigned int offset = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+    {
+        unsigned int const size = _query_ids[topo_id].extent( 0 );
+        if ( size == 0 )
+            continue;
+
+        Kokkos::View<Coordinate **, DeviceType> topo_points(
+            "topo_points_" + std::to_string( topo_id ), size, dim );
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "fill_topo_points" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, size ),
+            KOKKOS_LAMBDA( int const i ) {
+                for ( unsigned int d = 0; d < dim; ++d )
+                    topo_points( i, d ) = moved_points( offset + i, d );
+            } );
+        Kokkos::fence();
+
+        Kokkos::View<Coordinate **, DeviceType> topo_reference_points(
+            "topo_reference_points_" + std::to_string( topo_id ), size, dim );
+        Kokkos::deep_copy( topo_reference_points, _reference_points[topo_id] );
+        Kokkos::View<bool *, DeviceType> topo_point_in_cell(
+            "topo_point_in_cell_" + std::to_string( topo_id ), size );
+        PointInCell<DeviceType>::search(
+            mesh, node_offset, topo_points, _cell_indices[topo_id],
+            topologies[topo_id].topo, topo_reference_points,
+            topo_point_in_cell, true );
+
+        Kokkos::parallel_for( DTK_MARK_REGION( "fill_found" ),
+                              Kokkos::RangePolicy<ExecutionSpace>( 0, size ),
+                              KOKKOS_LAMBDA( int const i ) {
+                                  found( offset + i ) =
+                                      topo_point_in_cell( i ) ? 1 : 0;
+                              } );
+        Kokkos::fence();
+
+        // Only keep the points that are still in the cells
+        _ranks[topo_id] = filterInCell(
+            topo_point_in_cell, topo_reference_points, _cell_indices[topo_id],
+            _query_ids[topo_id], _ranks[topo_id], topo_id );
+
+        offset += size;
+    }
+
+    // Send back the results to the processors owning the points to find
+    // which points are not in any of their previous cells.
+    Kokkos::View<int *, DeviceType> imported_found( "imported_found",
+                                                    n_exports );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _target_to_source_distributor, found, imported_found );
+    Kokkos::View<int *, DeviceType> n_cells_found( "n_cells_found", _n_points );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "count_cells_found" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_exports ),
+        KOKKOS_LAMBDA( int const i ) {
+            if ( imported_found( i ) == 1 )
+                Kokkos::atomic_increment(
+                    &n_cells_found( update_query_ids( i ) ) );
+        } );
+    Kokkos::fence();
+
+    unsigned int const n_points = _n_points;
+    unsigned int n_lost_points = 0;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "compute_n_lost_points" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int const i, unsigned int &partial_sum ) {
+            if ( n_cells_found( i ) == 0 )
+                partial_sum += 1;
+        },
+        n_lost_points );
+    Kokkos::View<unsigned int *, DeviceType> lost_offset( "lost_offset",
+                                                          n_points );
+    Discretization::Helpers::computeOffset( n_cells_found, 0, lost_offset );
+    Kokkos::View<Coordinate **, DeviceType> lost_points( "lost_points",
+                                                         n_lost_points, dim );
+    Kokkos::View<int *, DeviceType> lost_query_ids( "lost_query_ids",
+                                                    n_lost_points );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "fill_lost_points" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int const i ) {
+            if ( n_cells_found( i ) == 0 )
+            {
+                unsigned int const k = lost_offset( i );
+                for ( unsigned int d = 0; d < dim; ++d )
+                    lost_points( k, d ) = points_coordinates( i, d );
+                lost_query_ids( k ) = i;
+            }
+        } );
+    Kokkos::fence();
+
+    // Search the points that have been lost using the distributed tree. This
+    // needs to be done by all the processors even if they have no points to
+    // search.
+    Kokkos::View<ArborX::Point *, DeviceType> imported_lost_points;
+    Kokkos::View<int *, DeviceType> imported_query_ids;
+    Kokkos::View<int *, DeviceType> imported_cell_indices;
+    Kokkos::View<int *, DeviceType> imported_ranks;
+    std::tie( imported_lost_points, imported_cell_indices, imported_query_ids,
+              imported_ranks ) =
+        performDistributedSearch( lost_points, lost_query_ids );
+
+    unsigned int const n_imports = imported_lost_points.extent( 0 );
+    Kokkos::View<unsigned int *, DeviceType> topo( "topo", n_imports );
+    Kokkos::View<unsigned int[DTK_N_TOPO], DeviceType> topo_size( "topo_size" );
+    internal::buildTopo( imported_cell_indices,
+                         _source_mesh_index->_mesh.cell_topologies, topo,
+                         topo_size );
+    auto topo_size_host = Kokkos::create_mirror_view( topo_size );
+    Kokkos::deep_copy( topo_size_host, topo_size );
+
+    // Append the new results to the ones that were kept
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+        if ( topo_size_host( topo_id ) != 0 )
+        {
+            auto kept_reference_points = _reference_points[topo_id];
+            auto kept_query_ids = _query_ids[topo_id];
+            auto kept_cell_indices = _cell_indices[topo_id];
+            auto kept_ranks = _ranks[topo_id];
+
+            auto new_ranks = performPointInCell(
+                imported_cell_indices, imported_lost_points,
+                imported_query_ids, imported_ranks, topo, topo_id,
+                topo_size_host( topo_id ) );
+
+            _reference_points[topo_id] = internal::concatenate(
+                kept_reference_points, _reference_points[topo_id] );
+            _query_ids[topo_id] =
+                internal::concatenate( kept_query_ids, _query_ids[topo_id] );
+            _cell_indices[topo_id] = internal::concatenate(
+                kept_cell_indices, _cell_indices[topo_id] );
+            _ranks[topo_id] = internal::concatenate( kept_ranks, new_ranks );
+        }
+
+    // The processors owning the points have changed so the distributors need
+    // to be built again.
+    build_distributor( _ranks );
+    _has_update_plan = false;
+
+    if ( _unique_results )
+        removeDuplicates();
 }
 
 template <typename DeviceType>
@@ -281,7 +1028,6 @@ PointSearch<DeviceType>::getSearchResults() const {
     MPI_Comm_rank( _comm, &comm_rank );
     Kokkos::deep_copy( ranks, comm_rank );
     Kokkos::View<int *, DeviceType> cell_indices( "cell_indices", n_ref_pts );
-    auto cell_indices_host = Kokkos::create_mirror_view( cell_indices );
     Kokkos::View<unsigned int *, DeviceType> query_ids( "query_ids",
                                                         n_ref_pts );
     Kokkos::View<Coordinate * [3], DeviceType> ref_pts( "ref_pts", n_ref_pts );
@@ -290,22 +1036,14 @@ PointSearch<DeviceType>::getSearchResults() const {
     {
         unsigned int const size = _query_ids[topo_id].extent( 0 );
 
-        // First fill cell_indices. This has to be done on the host because
-        // _cell_indices_map only exists on the host.
-        auto topo_cell_indices_host =
-            Kokkos::create_mirror_view( _cell_indices[topo_id] );
-        Kokkos::deep_copy( topo_cell_indices_host, _cell_indices[topo_id] );
-        for ( unsigned int i = 0; i < size; ++i )
-        {
-            cell_indices_host( i + n_copied_pts ) =
-                _cell_indices_map[topo_id][topo_cell_indices_host( i )];
-        }
-
-        // Fill query_ids
+        // Fill cell_indices and query_ids
+        auto topo_cell_indices = _cell_indices[topo_id];
         auto topo_query_ids = _query_ids[topo_id];
-        Kokkos::parallel_for( DTK_MARK_REGION( "query_ids" ),
+        Kokkos::parallel_for( DTK_MARK_REGION( "cell_indices_and_query_ids" ),
                               Kokkos::RangePolicy<ExecutionSpace>( 0, size ),
                               KOKKOS_LAMBDA( int const i ) {
+                                  cell_indices( i + n_copied_pts ) =
+                                      topo_cell_indices( i );
                                   query_ids( i + n_copied_pts ) =
                                       topo_query_ids( i );
                               } );
@@ -325,7 +1063,6 @@ PointSearch<DeviceType>::getSearchResults() const {
 
         n_copied_pts += size;
     }
-    Kokkos::deep_copy( cell_indices, cell_indices_host );
 
     // Communicate the results
     unsigned int n_imports =
@@ -379,31 +1116,39 @@ std::tuple<Kokkos::View<ArborX::Point *, DeviceType>,
            Kokkos::View<int *, DeviceType>> PointSearch<DeviceType>::
     performDistributedSearch(
         Kokkos::View<Coordinate **, DeviceType> points_coord,
-        Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes )
+        Kokkos::View<int *, DeviceType> query_ids )
 {
-    DTK_REQUIRE( points_coord.extent( 1 ) == 3 );
+    DTK_REQUIRE( points_coord.extent( 1 ) == _dim );
 
     using ExecutionSpace = typename DeviceType::execution_space;
-    using MemorySpace = typename DeviceType::memory_space;
+    auto const &distributed_tree = *( _source_mesh_index->_distributed_tree );
 
-    ArborX::DistributedTree<MemorySpace> distributed_tree(
-        _comm, ExecutionSpace{}, bounding_boxes );
+    // Redistribute the points among the processors. The query ids and the
+    // ranks of the processors owning the points are kept so that the results
+    // are associated to the initial points.
+    Kokkos::View<int *, DeviceType> query_ranks( "query_ranks", 0 );
+    if ( _balance_queries )
+        std::tie( points_coord, query_ids, query_ranks ) =
+            internal::balanceQueries( _comm, points_coord, query_ids );
 
     unsigned int const n_points = points_coord.extent( 0 );
+    unsigned int const dim = _dim;
 
-    // Build the queries
+    // Build the queries. The 2D points are in the z = 0 plane, like the
+    // bounding boxes of the 2D cells.
     Kokkos::View<decltype( ArborX::intersects( ArborX::Sphere{} ) ) *,
                  DeviceType>
         queries( "queries", n_points );
-    Kokkos::parallel_for( DTK_MARK_REGION( "register_queries" ),
-                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
-                          KOKKOS_LAMBDA( int i ) {
-                              queries( i ) = ArborX::intersects( ArborX::Sphere{
-                                  {static_cast<float>( points_coord( i, 0 ) ),
-                                   static_cast<float>( points_coord( i, 1 ) ),
-                                   static_cast<float>( points_coord( i, 2 ) )},
-                                  0.} );
-                          } );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "register_queries" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int i ) {
+            queries( i ) = ArborX::intersects( ArborX::Sphere{
+                {static_cast<float>( points_coord( i, 0 ) ),
+                 static_cast<float>( points_coord( i, 1 ) ),
+                 dim == 3 ? static_cast<float>( points_coord( i, 2 ) ) : 0.f},
+                0.} );
+        } );
     Kokkos::fence();
 
     // Perform the distributed search
@@ -418,8 +1163,18 @@ std::tuple<Kokkos::View<ArborX::Point *, DeviceType>,
     Details::splitIndexRank( index_rank, indices, ranks );
 
     // Move the points from the source processors to the target processors
-    return internal::moveDataFromSourceToTarget( _comm, indices, offset, ranks,
-                                                 points_coord, _dim );
+    auto imported_data = internal::moveDataFromSourceToTarget(
+        _comm, indices, offset, ranks, points_coord, query_ids, query_ranks,
+        _dim );
+
+    // Remove the candidates that are outside of the k-DOPs of the cells
+    auto kdops = _source_mesh_index->_kdops;
+    if ( kdops.extent( 0 ) == 0 )
+        return imported_data;
+
+    return internal::filterKDOPs(
+        kdops, std::get<0>( imported_data ), std::get<1>( imported_data ),
+        std::get<2>( imported_data ), std::get<3>( imported_data ) );
 }
 
 template <typename DeviceType>
@@ -428,16 +1183,13 @@ std::tuple<Kokkos::View<int *, DeviceType>,
            Kokkos::View<int *, DeviceType>, Kokkos::View<int *, DeviceType>>
 PointSearch<DeviceType>::filterTopology(
     Kokkos::View<unsigned int *, DeviceType> topo, unsigned int topo_id,
-    unsigned int size,
-    Kokkos::View<unsigned int **, DeviceType> bounding_box_to_cell,
-    Kokkos::View<int *, DeviceType> cell_indices,
+    unsigned int size, Kokkos::View<int *, DeviceType> cell_indices,
     Kokkos::View<ArborX::Point *, DeviceType> points,
     Kokkos::View<int *, DeviceType> query_ids,
     Kokkos::View<int *, DeviceType> ranks )
 {
     DTK_REQUIRE( topo.extent( 0 ) == ranks.extent( 0 ) );
     DTK_REQUIRE( query_ids.extent( 0 ) == ranks.extent( 0 ) );
-    DTK_REQUIRE( bounding_box_to_cell.extent( 1 ) > topo_id );
 
     using ExecutionSpace = typename DeviceType::execution_space;
     unsigned int const n_imports = topo.extent( 0 );
@@ -462,8 +1214,7 @@ PointSearch<DeviceType>::filterTopology(
             if ( topo( i ) == topo_id )
             {
                 unsigned int const k = offset( i );
-                filtered_per_topo_cell_indices( k ) =
-                    bounding_box_to_cell( cell_indices( i ), topo_id );
+                filtered_per_topo_cell_indices( k ) = cell_indices( i );
                 for ( unsigned int j = 0; j < dim; ++j )
                     filtered_per_topo_points( k, j ) = points( i )[j];
                 filtered_per_topo_query_ids( k ) = query_ids( i );
@@ -546,8 +1297,6 @@ Kokkos::View<int *, DeviceType> PointSearch<DeviceType>::filterInCell(
 
 template <typename DeviceType>
 Kokkos::View<int *, DeviceType> PointSearch<DeviceType>::performPointInCell(
-    Kokkos::View<Coordinate ***, DeviceType> cells,
-    Kokkos::View<unsigned int **, DeviceType> bounding_box_to_cell,
     Kokkos::View<int *, DeviceType> imported_cell_indices,
     Kokkos::View<ArborX::Point *, DeviceType> imported_points,
     Kokkos::View<int *, DeviceType> imported_query_ids,
@@ -562,9 +1311,8 @@ Kokkos::View<int *, DeviceType> PointSearch<DeviceType>::performPointInCell(
     Kokkos::View<int *, DeviceType> filtered_per_topo_ranks;
     std::tie( filtered_per_topo_cell_indices, filtered_per_topo_points,
               filtered_per_topo_query_ids, filtered_per_topo_ranks ) =
-        filterTopology( topo, topo_id, size, bounding_box_to_cell,
-                        imported_cell_indices, imported_points,
-                        imported_query_ids, imported_ranks );
+        filterTopology( topo, topo_id, size, imported_cell_indices,
+                        imported_points, imported_query_ids, imported_ranks );
 
     // Perform the PointInCell search
     Topologies topologies;
@@ -574,7 +1322,8 @@ Kokkos::View<int *, DeviceType> PointSearch<DeviceType>::performPointInCell(
     Kokkos::View<bool *, DeviceType> filtered_per_topo_point_in_cell(
         "filtered_per_topo_point_in_cell_" + std::to_string( topo_id ), size );
     PointInCell<DeviceType>::search(
-        filtered_per_topo_points, cells, filtered_per_topo_cell_indices,
+        _source_mesh_index->_mesh, _source_mesh_index->_node_offset,
+        filtered_per_topo_points, filtered_per_topo_cell_indices,
         topologies[topo_id].topo, filtered_per_topo_reference_points,
         filtered_per_topo_point_in_cell );
 
@@ -593,22 +1342,26 @@ void PointSearch<DeviceType>::build_distributor(
     std::array<Kokkos::View<int *, DeviceType>, DTK_N_TOPO> const
         &filtered_ranks )
 {
-    // Flatten the filtered ranks to be used by the distributor
-    std::vector<int> flatten_ranks;
+    // Flatten the filtered ranks to be used by the distributor. The ranks of
+    // each topology are copied one after the other on the device.
+    unsigned int n_ranks = 0;
+    for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
+        n_ranks += filtered_ranks[topo_id].extent( 0 );
+    Kokkos::View<int *, DeviceType> flatten_ranks( "flatten_ranks", n_ranks );
+    unsigned int offset = 0;
     for ( unsigned int topo_id = 0; topo_id < DTK_N_TOPO; ++topo_id )
     {
-        auto rank_host = Kokkos::create_mirror_view( filtered_ranks[topo_id] );
-        Kokkos::deep_copy( rank_host, filtered_ranks[topo_id] );
-        unsigned int const rank_host_size = rank_host.size();
-        for ( unsigned int i = 0; i < rank_host_size; ++i )
-            flatten_ranks.push_back( rank_host( i ) );
+        unsigned int const topo_size = filtered_ranks[topo_id].extent( 0 );
+        Kokkos::deep_copy(
+            Kokkos::subview( flatten_ranks, Kokkos::make_pair(
+                                                offset, offset + topo_size ) ),
+            filtered_ranks[topo_id] );
+        offset += topo_size;
     }
 
-    Kokkos::DefaultHostExecutionSpace space;
-    _target_to_source_distributor.createFromSends(
-        space, Kokkos::View<int const *, Kokkos::HostSpace,
-                            Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
-                   flatten_ranks.data(), flatten_ranks.size() ) );
+    using ExecutionSpace = typename DeviceType::execution_space;
+    _target_to_source_distributor.createFromSends( ExecutionSpace{},
+                                                   flatten_ranks );
 }
 } // namespace DataTransferKit
 
@@ -0,0 +1,125 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DTK_SOURCE_MESH_INDEX_DECL_HPP
+#define DTK_SOURCE_MESH_INDEX_DECL_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <ArborX.hpp>
+#include <DTK_CellTypes.h>
+#include <DTK_Mesh.hpp>
+
+#include <Kokkos_View.hpp>
+
+#include <mpi.h>
+
+#include <memory>
+
+namespace DataTransferKit
+{
+/**
+ * This class preprocesses a mesh for the search of points: it computes the
+ * offsets of the cells in the connectivity of the mesh and builds the
+ * distributed search tree over the bounding boxes of the cells. The object can
+ * be shared by several PointSearch and Interpolation objects that look for
+ * different sets of points in the same mesh. This way the preprocessing is
+ * only done once.
+ */
+template <typename DeviceType>
+class SourceMeshIndex
+{
+  public:
+    using MemorySpace = typename DeviceType::memory_space;
+
+    /**
+     * Constructor.
+     * @param comm
+     * @param mesh mesh of the domain of interest
+     * @param box_margin the bounding boxes stored in the search tree are
+     * enlarged by \p box_margin times their extent in each direction. Larger
+     * boxes make refit() cheaper when the mesh deforms but the search returns
+     * more candidate cells.
+     * @param use_kdops if true, an 18-DOP (discrete oriented polytope) is built
+     * around each cell. The candidates returned by the search tree are
+     * checked against the 18-DOPs of the cells before the expensive
+     * PointInCell search. This is useful when the bounding boxes are loose,
+     * e.g. for thin, skewed, or curved cells.
+     */
+    SourceMeshIndex( MPI_Comm comm, Mesh<DeviceType> const &mesh,
+                     double box_margin = 0., bool use_kdops = false );
+
+    /**
+     * Update the index after the nodes of the mesh have moved. The
+     * connectivity of the mesh must be unchanged. The bounding boxes (and the
+     * 18-DOPs) of the cells are recomputed. The search tree is
+     * only rebuilt if a bounding box is not contained anymore in the box
+     * stored in the tree or if the ratio between the volume of the bounding
+     * boxes and the volume of the bounding boxes of the cells when the tree
+     * was built is less than \p min_quality on one of the processors. The
+     * volumes do not include \p box_margin. PointSearch and Interpolation
+     * objects built before the call must be built again (or updated).
+     * @param nodes_coordinates new coordinates of the nodes of the mesh
+     * @param min_quality minimum ratio between the volume of the bounding
+     * boxes and the volume of the bounding boxes when the tree was built.
+     * @return true if the search tree has been rebuilt.
+     */
+    bool refit( Kokkos::View<Coordinate **, DeviceType> nodes_coordinates,
+                double min_quality = 0.5 );
+
+    /**
+     * Return the communicator associated to the mesh.
+     */
+    MPI_Comm getComm() const { return _comm; }
+
+    /**
+     * Return the dimension of the mesh.
+     */
+    unsigned int getDim() const { return _dim; }
+
+  private:
+    /**
+     * Enlarge the bounding boxes and build the distributed search tree.
+     */
+    void buildTree();
+
+    template <typename T>
+    friend class PointSearch;
+    template <typename T>
+    friend class Interpolation;
+
+    MPI_Comm _comm;
+    Mesh<DeviceType> _mesh;
+    unsigned int _dim;
+    /**
+     * Offset of the first node of each cell in the cells View of the mesh.
+     */
+    Kokkos::View<unsigned int *, DeviceType> _node_offset;
+    /**
+     * Bounding boxes stored in the search tree. They contain the bounding
+     * boxes of the cells enlarged by _box_margin.
+     */
+    Kokkos::View<ArborX::Box *, DeviceType> _bounding_boxes;
+    double _box_margin;
+    /**
+     * Volume of the bounding boxes of the cells, before they are enlarged,
+     * when the tree was built.
+     */
+    double _bounding_boxes_volume;
+    /**
+     * Optional 18-DOPs of the cells (n cells, 2 * n_kdop_directions). Empty
+     * if the 18-DOPs are not used.
+     */
+    Kokkos::View<Coordinate **, DeviceType> _kdops;
+    std::unique_ptr<ArborX::DistributedTree<MemorySpace>> _distributed_tree;
+};
+} // namespace DataTransferKit
+
+#endif
@@ -0,0 +1,138 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DTK_SOURCE_MESH_INDEX_DEF_HPP
+#define DTK_SOURCE_MESH_INDEX_DEF_HPP
+
+#include <DTK_DBC.hpp>
+#include <DTK_DiscretizationHelpers.hpp>
+
+#include <mpi.h>
+
+namespace DataTransferKit
+{
+template <typename DeviceType>
+SourceMeshIndex<DeviceType>::SourceMeshIndex( MPI_Comm comm,
+                                              Mesh<DeviceType> const &mesh,
+                                              double box_margin,
+                                              bool use_kdops )
+    : _comm( comm )
+    , _mesh( mesh )
+    , _dim( mesh.nodes_coordinates.extent( 1 ) )
+    , _box_margin( box_margin )
+{
+    DTK_REQUIRE( box_margin >= 0. );
+
+    // Compute the position of the first node of each cell in the
+    // connectivity. The nodes of the cells are always read through the
+    // connectivity so the coordinates of the nodes are never duplicated.
+    Discretization::Helpers::MeshOffsets<DeviceType> mesh_offsets( mesh );
+    _node_offset = mesh_offsets.node_offset;
+
+    _bounding_boxes = Kokkos::View<ArborX::Box *, DeviceType>(
+        "bounding_boxes", mesh.cell_topologies.extent( 0 ) );
+    Discretization::Helpers::createBoundingBoxes( mesh, _node_offset,
+                                                  _bounding_boxes );
+    if ( use_kdops )
+    {
+        _kdops = Kokkos::View<Coordinate **, DeviceType>(
+            "kdops", mesh.cell_topologies.extent( 0 ),
+            2 * Discretization::Helpers::n_kdop_directions );
+        Discretization::Helpers::createKDOPs( mesh, _node_offset, _kdops );
+    }
+
+    // Build the distributed search tree over the bounding boxes.
+    buildTree();
+}
+
+template <typename DeviceType>
+void SourceMeshIndex<DeviceType>::buildTree()
+{
+    // The volume is computed before the boxes are enlarged so that refit()
+    // compares the bounding boxes of the cells with the same quantity.
+    _bounding_boxes_volume =
+        Discretization::Helpers::computeBoundingBoxesVolume( _dim,
+                                                             _bounding_boxes );
+    if ( _box_margin > 0. )
+        Discretization::Helpers::fattenBoundingBoxes( _dim, _box_margin,
+                                                      _bounding_boxes );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+    _distributed_tree.reset( new ArborX::DistributedTree<MemorySpace>(
+        _comm, ExecutionSpace{}, _bounding_boxes ) );
+}
+
+template <typename DeviceType>
+bool SourceMeshIndex<DeviceType>::refit(
+    Kokkos::View<Coordinate **, DeviceType> nodes_coordinates,
+    double min_quality )
+{
+    DTK_REQUIRE( nodes_coordinates.extent( 0 ) ==
+                 _mesh.nodes_coordinates.extent( 0 ) );
+    DTK_REQUIRE( nodes_coordinates.extent( 1 ) == _dim );
+
+    // Recompute the bounding boxes
+    _mesh.nodes_coordinates = nodes_coordinates;
+    unsigned int const n_cells = _mesh.cell_topologies.extent( 0 );
+    Kokkos::View<ArborX::Box *, DeviceType> bounding_boxes( "bounding_boxes",
+                                                            n_cells );
+    Discretization::Helpers::createBoundingBoxes( _mesh, _node_offset,
+                                                  bounding_boxes );
+    if ( _kdops.extent( 0 ) != 0 )
+        Discretization::Helpers::createKDOPs( _mesh, _node_offset, _kdops );
+
+    // ArborX does not allow to update the boxes of an existing tree. However,
+    // the tree is still valid if the new bounding boxes are contained in the
+    // boxes stored in the tree: the search may return more candidates but the
+    // candidates are checked by PointInCell anyway.
+    using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int const dim = _dim;
+    auto stored_bounding_boxes = _bounding_boxes;
+    int n_escaped_boxes = 0;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "count_escaped_boxes" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_cells ),
+        KOKKOS_LAMBDA( int const i, int &partial_sum ) {
+            auto const &box = bounding_boxes( i );
+            auto const &stored_box = stored_bounding_boxes( i );
+            for ( unsigned int d = 0; d < dim; ++d )
+                if ( ( box.minCorner()[d] < stored_box.minCorner()[d] ) ||
+                     ( box.maxCorner()[d] > stored_box.maxCorner()[d] ) )
+                {
+                    partial_sum += 1;
+                    break;
+                }
+        },
+        n_escaped_boxes );
+    double const volume =
+        Discretization::Helpers::computeBoundingBoxesVolume( _dim,
+                                                             bounding_boxes );
+    int rebuild = ( n_escaped_boxes > 0 ) ||
+                  ( volume < min_quality * _bounding_boxes_volume );
+
+    // The distributed tree is built collectively so all the processors need
+    // to agree.
+    MPI_Allreduce( MPI_IN_PLACE, &rebuild, 1, MPI_INT, MPI_LOR, _comm );
+    if ( rebuild )
+    {
+        _bounding_boxes = bounding_boxes;
+        buildTree();
+    }
+
+    return rebuild;
+}
+} // namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_SOURCEMESHINDEX_INSTANT( NODE )                                    \
+    template class SourceMeshIndex<typename NODE::device_type>;
+
+#endif
@@ -0,0 +1,121 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DTK_STRUCTURED_POINT_SEARCH_DECL_HPP
+#define DTK_STRUCTURED_POINT_SEARCH_DECL_HPP
+
+#include "DTK_ConfigDefs.hpp"
+#include <ArborX.hpp>
+
+#include <Kokkos_View.hpp>
+
+#include <mpi.h>
+
+#include <array>
+#include <tuple>
+
+namespace DataTransferKit
+{
+/**
+ * This class performs the search of a set of given points in a Cartesian
+ * grid. The grid is decomposed in blocks and each processor owns one block
+ * described by its edges (node locations) along each axis. A block can be
+ * owned by several processors when the grid is replicated. Unlike
+ * PointSearch, the cells and the positions of the points in the reference
+ * frame are computed arithmetically and the processors owning the points are
+ * found using the bounds of the blocks. The cells of a block are numbered
+ * lexicographically, the x index varying the fastest.
+ *
+ * A point on the boundary between two cells or two blocks is only associated
+ * to the cell with the largest index.
+ */
+template <typename DeviceType>
+class StructuredPointSearch
+{
+  public:
+    /**
+     * Constructor. The search of the points is done in the constructor but
+     * the results is not send back to the calling processor.
+     * @param comm
+     * @param local_edges sorted edges of the local block along each axis. The
+     * edges along the unused axes are ignored when the points are 2D.
+     * @param points_coordinates coordinates in the physical frame of the points
+     * that we are looking for.
+     */
+    StructuredPointSearch(
+        MPI_Comm comm,
+        std::array<Kokkos::View<Coordinate *, DeviceType>, 3> const
+            &local_edges,
+        Kokkos::View<Coordinate **, DeviceType> points_coordinates );
+
+    /**
+     * Return the result of the search. The tuple contains the rank where the
+     * points are found, the cell indices associated to the points (local IDs),
+     * the coordinates of the points in the frame of reference, and the query
+     * ids associated to each point.
+     */
+    std::tuple<Kokkos::View<int *, DeviceType>, Kokkos::View<int *, DeviceType>,
+               Kokkos::View<Coordinate * [3], DeviceType>,
+               Kokkos::View<unsigned int *, DeviceType>>
+    getSearchResults() const;
+
+    /**
+     * Find the processors owning the blocks where the points are and send the
+     * points to them. Return the points, the query ids, and the ranks of the
+     * processors owning the points.
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
+    std::tuple<Kokkos::View<Coordinate **, DeviceType>,
+               Kokkos::View<int *, DeviceType>, Kokkos::View<int *, DeviceType>>
+    sendPointsToBlocks( Kokkos::View<Coordinate **, DeviceType> points_coord );
+
+    /**
+     * Compute the cells where the points are found and the position of the
+     * points in the reference frame of these cells.
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
+    void locatePointsInBlock(
+        Kokkos::View<Coordinate **, DeviceType> imported_points,
+        Kokkos::View<int *, DeviceType> imported_query_ids,
+        Kokkos::View<int *, DeviceType> imported_ranks );
+
+  private:
+    /**
+     * Gather the bounds of the blocks owned by all the processors and build
+     * the table used to find the processor owning a block.
+     */
+    void buildBlockTable();
+
+    MPI_Comm _comm;
+    ArborX::Details::Distributor<DeviceType> _target_to_source_distributor;
+    unsigned int _dim;
+    std::array<Kokkos::View<Coordinate *, DeviceType>, 3> _local_edges;
+    // Lower bounds of the blocks along each axis followed by the upper bound
+    // of the grid
+    std::array<Kokkos::View<Coordinate *, DeviceType>, 3> _block_edges;
+    // Rank of the processor owning each block for each replica of the grid
+    Kokkos::View<int **, DeviceType> _block_ranks;
+    // Replica of the grid the current processor belongs to
+    int _set_id;
+    Kokkos::View<Coordinate **, DeviceType> _reference_points;
+    Kokkos::View<int *, DeviceType> _query_ids;
+    // Indices of the cells in the local block
+    Kokkos::View<int *, DeviceType> _cell_indices;
+    // Rank of the processor that owns the point
+    Kokkos::View<int *, DeviceType> _ranks;
+};
+} // namespace DataTransferKit
+
+#endif
@@ -0,0 +1,431 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DTK_STRUCTURED_POINT_SEARCH_DEF_HPP
+#define DTK_STRUCTURED_POINT_SEARCH_DEF_HPP
+
+#include <ArborX.hpp>
+#include <DTK_DBC.hpp>
+#include <DTK_DiscretizationHelpers.hpp>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace DataTransferKit
+{
+namespace internal
+{
+// Return the index i such that edges(i) <= x < edges(i+1). A point on the
+// last edge belongs to the last interval. Return -1 if the point is outside.
+template <typename View>
+KOKKOS_INLINE_FUNCTION int findInterval( View const &edges, Coordinate x )
+{
+    int const n_edges = edges.extent( 0 );
+    if ( ( n_edges < 2 ) || ( x < edges( 0 ) ) ||
+         ( x > edges( n_edges - 1 ) ) )
+        return -1;
+
+    // Find the first edge greater than x
+    int first = 0;
+    int last = n_edges;
+    while ( first < last )
+    {
+        int const mid = ( first + last ) / 2;
+        if ( edges( mid ) <= x )
+            first = mid + 1;
+        else
+            last = mid;
+    }
+
+    return ( first == n_edges ) ? n_edges - 2 : first - 1;
+}
+} // namespace internal
+
+template <typename DeviceType>
+StructuredPointSearch<DeviceType>::StructuredPointSearch(
+    MPI_Comm comm,
+    std::array<Kokkos::View<Coordinate *, DeviceType>, 3> const &local_edges,
+    Kokkos::View<Coordinate **, DeviceType> points_coordinates )
+    : _comm( comm )
+    , _target_to_source_distributor( comm )
+    , _dim( points_coordinates.extent( 1 ) )
+    , _local_edges( local_edges )
+{
+    DTK_REQUIRE( ( _dim == 2 ) || ( _dim == 3 ) );
+    for ( unsigned int d = 0; d < _dim; ++d )
+        DTK_REQUIRE( _local_edges[d].extent( 0 ) > 1 );
+
+    buildBlockTable();
+
+    // Send the points to the processors owning the blocks where they are
+    Kokkos::View<Coordinate **, DeviceType> imported_points;
+    Kokkos::View<int *, DeviceType> imported_query_ids;
+    Kokkos::View<int *, DeviceType> imported_ranks;
+    std::tie( imported_points, imported_query_ids, imported_ranks ) =
+        sendPointsToBlocks( points_coordinates );
+
+    // Find the cells in the block
+    locatePointsInBlock( imported_points, imported_query_ids, imported_ranks );
+
+    // Build the distributor used to send the results back
+    auto ranks_host = Kokkos::create_mirror_view( _ranks );
+    Kokkos::deep_copy( ranks_host, _ranks );
+    _target_to_source_distributor.createFromSends(
+        Kokkos::DefaultHostExecutionSpace{}, ranks_host );
+}
+
+template <typename DeviceType>
+void StructuredPointSearch<DeviceType>::buildBlockTable()
+{
+    int comm_rank;
+    MPI_Comm_rank( _comm, &comm_rank );
+    int comm_size;
+    MPI_Comm_size( _comm, &comm_size );
+
+    // Gather the bounds of the blocks of all the processors
+    std::vector<double> local_bounds( 6, 0. );
+    for ( unsigned int d = 0; d < _dim; ++d )
+    {
+        auto edges_host = Kokkos::create_mirror_view( _local_edges[d] );
+        Kokkos::deep_copy( edges_host, _local_edges[d] );
+        local_bounds[2 * d] = edges_host( 0 );
+        local_bounds[2 * d + 1] = edges_host( edges_host.extent( 0 ) - 1 );
+    }
+    std::vector<double> bounds( 6 * comm_size );
+    MPI_Allgather( local_bounds.data(), 6, MPI_DOUBLE, bounds.data(), 6,
+                   MPI_DOUBLE, _comm );
+
+    // The lower bounds of the blocks along each axis define the block
+    // decomposition
+    std::array<std::vector<double>, 3> lower_bounds;
+    std::array<int, 3> n_blocks = {{1, 1, 1}};
+    for ( unsigned int d = 0; d < _dim; ++d )
+    {
+        double upper_bound = bounds[2 * d + 1];
+        for ( int r = 0; r < comm_size; ++r )
+        {
+            lower_bounds[d].push_back( bounds[6 * r + 2 * d] );
+            upper_bound = std::max( upper_bound, bounds[6 * r + 2 * d + 1] );
+        }
+        std::sort( lower_bounds[d].begin(), lower_bounds[d].end() );
+        lower_bounds[d].erase(
+            std::unique( lower_bounds[d].begin(), lower_bounds[d].end() ),
+            lower_bounds[d].end() );
+        n_blocks[d] = lower_bounds[d].size();
+
+        _block_edges[d] = Kokkos::View<Coordinate *, DeviceType>(
+            "block_edges_" + std::to_string( d ), n_blocks[d] + 1 );
+        auto block_edges_host = Kokkos::create_mirror_view( _block_edges[d] );
+        for ( int b = 0; b < n_blocks[d]; ++b )
+            block_edges_host( b ) = lower_bounds[d][b];
+        block_edges_host( n_blocks[d] ) = upper_bound;
+        Kokkos::deep_copy( _block_edges[d], block_edges_host );
+    }
+
+    // Find the block of each processor. When the grid is replicated, the
+    // i-th processor owning a block belongs to the i-th replica.
+    int const n_total_blocks = n_blocks[0] * n_blocks[1] * n_blocks[2];
+    std::vector<std::vector<int>> block_owners( n_total_blocks );
+    for ( int r = 0; r < comm_size; ++r )
+    {
+        std::array<int, 3> block_ijk = {{0, 0, 0}};
+        for ( unsigned int d = 0; d < _dim; ++d )
+            block_ijk[d] = std::lower_bound( lower_bounds[d].begin(),
+                                             lower_bounds[d].end(),
+                                             bounds[6 * r + 2 * d] ) -
+                           lower_bounds[d].begin();
+        int const block_id =
+            block_ijk[0] +
+            n_blocks[0] * ( block_ijk[1] + n_blocks[1] * block_ijk[2] );
+        if ( r == comm_rank )
+            _set_id = block_owners[block_id].size();
+        block_owners[block_id].push_back( r );
+    }
+
+    // The points of a replica are sent to the processors of the same replica
+    // when possible
+    unsigned int n_sets = 0;
+    for ( auto const &owners : block_owners )
+        n_sets = std::max<unsigned int>( n_sets, owners.size() );
+    _block_ranks = Kokkos::View<int **, DeviceType>( "block_ranks", n_sets,
+                                                     n_total_blocks );
+    auto block_ranks_host = Kokkos::create_mirror_view( _block_ranks );
+    for ( unsigned int s = 0; s < n_sets; ++s )
+        for ( int b = 0; b < n_total_blocks; ++b )
+            block_ranks_host( s, b ) =
+                block_owners[b].empty()
+                    ? -1
+                    : block_owners[b][s % block_owners[b].size()];
+    Kokkos::deep_copy( _block_ranks, block_ranks_host );
+}
+
+template <typename DeviceType>
+std::tuple<Kokkos::View<Coordinate **, DeviceType>,
+           Kokkos::View<int *, DeviceType>, Kokkos::View<int *, DeviceType>>
+StructuredPointSearch<DeviceType>::sendPointsToBlocks(
+    Kokkos::View<Coordinate **, DeviceType> points_coord )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    ExecutionSpace space;
+
+    // Find the processor owning the block of each point
+    unsigned int const n_points = points_coord.extent( 0 );
+    unsigned int const dim = _dim;
+    auto x_block_edges = _block_edges[0];
+    auto y_block_edges = _block_edges[1];
+    auto z_block_edges = _block_edges[2];
+    int const n_x_blocks = x_block_edges.extent( 0 ) - 1;
+    int const n_y_blocks = y_block_edges.extent( 0 ) - 1;
+    auto block_ranks = Kokkos::subview( _block_ranks, _set_id, Kokkos::ALL );
+    Kokkos::View<int *, DeviceType> destination_ranks( "destination_ranks",
+                                                       n_points );
+    Kokkos::View<bool *, DeviceType> in_grid( "in_grid", n_points );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "find_blocks" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int const i ) {
+            int const block_i =
+                internal::findInterval( x_block_edges, points_coord( i, 0 ) );
+            int const block_j =
+                internal::findInterval( y_block_edges, points_coord( i, 1 ) );
+            int const block_k =
+                ( dim == 3 )
+                    ? internal::findInterval( z_block_edges,
+                                              points_coord( i, 2 ) )
+                    : 0;
+            int const rank =
+                ( ( block_i < 0 ) || ( block_j < 0 ) || ( block_k < 0 ) )
+                    ? -1
+                    : block_ranks( block_i +
+                                   n_x_blocks *
+                                       ( block_j + n_y_blocks * block_k ) );
+            destination_ranks( i ) = rank;
+            in_grid( i ) = ( rank >= 0 );
+        } );
+    Kokkos::fence();
+
+    // Only send the points that are inside the grid
+    unsigned int n_exports = 0;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "compute_n_exports" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int const i, unsigned int &partial_sum ) {
+            if ( in_grid( i ) )
+                partial_sum += 1;
+        },
+        n_exports );
+    Kokkos::View<unsigned int *, DeviceType> offset( "offset", n_points );
+    Discretization::Helpers::computeOffset( in_grid, true, offset );
+    Kokkos::View<Coordinate **, DeviceType> exported_points( "exported_points",
+                                                             n_exports, dim );
+    Kokkos::View<int *, DeviceType> exported_query_ids( "exported_query_ids",
+                                                        n_exports );
+    Kokkos::View<int *, DeviceType> exported_destinations(
+        "exported_destinations", n_exports );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "pack_points" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+        KOKKOS_LAMBDA( int const i ) {
+            if ( in_grid( i ) )
+            {
+                unsigned int const k = offset( i );
+                for ( unsigned int d = 0; d < dim; ++d )
+                    exported_points( k, d ) = points_coord( i, d );
+                exported_query_ids( k ) = i;
+                exported_destinations( k ) = destination_ranks( i );
+            }
+        } );
+    Kokkos::fence();
+    int comm_rank;
+    MPI_Comm_rank( _comm, &comm_rank );
+    Kokkos::View<int *, DeviceType> exported_ranks( "exported_ranks",
+                                                    n_exports );
+    Kokkos::deep_copy( exported_ranks, comm_rank );
+
+    auto destinations_host =
+        Kokkos::create_mirror_view( exported_destinations );
+    Kokkos::deep_copy( destinations_host, exported_destinations );
+    ArborX::Details::Distributor<DeviceType> distributor( _comm );
+    unsigned int const n_imports =
+        distributor.createFromSends( space, destinations_host );
+    Kokkos::View<Coordinate **, DeviceType> imported_points( "imported_points",
+                                                             n_imports, dim );
+    Kokkos::View<int *, DeviceType> imported_query_ids( "imported_query_ids",
+                                                        n_imports );
+    Kokkos::View<int *, DeviceType> imported_ranks( "imported_ranks",
+                                                    n_imports );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, distributor, exported_points, imported_points );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, distributor, exported_query_ids, imported_query_ids );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, distributor, exported_ranks, imported_ranks );
+
+    return std::make_tuple( imported_points, imported_query_ids,
+                            imported_ranks );
+}
+
+template <typename DeviceType>
+void StructuredPointSearch<DeviceType>::locatePointsInBlock(
+    Kokkos::View<Coordinate **, DeviceType> imported_points,
+    Kokkos::View<int *, DeviceType> imported_query_ids,
+    Kokkos::View<int *, DeviceType> imported_ranks )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    // Compute the cell and the position in the reference frame of each point.
+    // The reference cell is [-1, 1]^dim.
+    unsigned int const n_imports = imported_points.extent( 0 );
+    unsigned int const dim = _dim;
+    auto x_edges = _local_edges[0];
+    auto y_edges = _local_edges[1];
+    auto z_edges = _local_edges[2];
+    int const n_x_cells = x_edges.extent( 0 ) - 1;
+    int const n_y_cells = y_edges.extent( 0 ) - 1;
+    Kokkos::View<int *, DeviceType> cell_indices( "cell_indices", n_imports );
+    Kokkos::View<Coordinate **, DeviceType> reference_points(
+        "reference_points", n_imports, dim );
+    Kokkos::View<bool *, DeviceType> in_block( "in_block", n_imports );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "locate_points" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
+        KOKKOS_LAMBDA( int const i ) {
+            int cell_ijk[3] = {0, 0, 0};
+            bool found = true;
+            for ( unsigned int d = 0; d < dim; ++d )
+            {
+                auto const &edges =
+                    ( d == 0 ) ? x_edges : ( ( d == 1 ) ? y_edges : z_edges );
+                Coordinate const x = imported_points( i, d );
+                int const c = internal::findInterval( edges, x );
+                if ( c < 0 )
+                {
+                    found = false;
+                    break;
+                }
+                cell_ijk[d] = c;
+                reference_points( i, d ) =
+                    2. * ( x - edges( c ) ) / ( edges( c + 1 ) - edges( c ) ) -
+                    1.;
+            }
+            in_block( i ) = found;
+            cell_indices( i ) =
+                cell_ijk[0] +
+                n_x_cells * ( cell_ijk[1] + n_y_cells * cell_ijk[2] );
+        } );
+    Kokkos::fence();
+
+    // Remove the points that are not in the block. This can only happen if
+    // the edges of neighboring blocks do not match exactly.
+    int n_found = 0;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "compute_n_found" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
+        KOKKOS_LAMBDA( int const i, int &partial_sum ) {
+            if ( in_block( i ) )
+                partial_sum += 1;
+        },
+        n_found );
+    Kokkos::View<unsigned int *, DeviceType> offset( "offset", n_imports );
+    Discretization::Helpers::computeOffset( in_block, true, offset );
+    _reference_points =
+        Kokkos::View<Coordinate **, DeviceType>( "ref_pts", n_found, dim );
+    _query_ids = Kokkos::View<int *, DeviceType>( "query_ids", n_found );
+    _cell_indices = Kokkos::View<int *, DeviceType>( "cell_indices", n_found );
+    _ranks = Kokkos::View<int *, DeviceType>( "ranks", n_found );
+    auto ref_points = _reference_points;
+    auto query_ids = _query_ids;
+    auto found_cell_indices = _cell_indices;
+    auto ranks = _ranks;
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "filter" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
+        KOKKOS_LAMBDA( int const i ) {
+            if ( in_block( i ) )
+            {
+                unsigned int const k = offset( i );
+                for ( unsigned int d = 0; d < dim; ++d )
+                    ref_points( k, d ) = reference_points( i, d );
+                query_ids( k ) = imported_query_ids( i );
+                found_cell_indices( k ) = cell_indices( i );
+                ranks( k ) = imported_ranks( i );
+            }
+        } );
+    Kokkos::fence();
+}
+
+template <typename DeviceType>
+std::tuple<Kokkos::View<int *, DeviceType>, Kokkos::View<int *, DeviceType>,
+           Kokkos::View<Coordinate * [3], DeviceType>,
+           Kokkos::View<unsigned int *, DeviceType>>
+StructuredPointSearch<DeviceType>::getSearchResults() const
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int const n_ref_pts = _query_ids.extent( 0 );
+
+    int comm_rank;
+    MPI_Comm_rank( _comm, &comm_rank );
+    Kokkos::View<int *, DeviceType> ranks( "ranks", n_ref_pts );
+    Kokkos::deep_copy( ranks, comm_rank );
+    Kokkos::View<unsigned int *, DeviceType> query_ids( "query_ids",
+                                                        n_ref_pts );
+    Kokkos::View<Coordinate * [3], DeviceType> ref_pts( "ref_pts", n_ref_pts );
+    unsigned int const dim = _dim;
+    auto reference_points = _reference_points;
+    auto local_query_ids = _query_ids;
+    Kokkos::parallel_for( DTK_MARK_REGION( "fill_results" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_ref_pts ),
+                          KOKKOS_LAMBDA( int const i ) {
+                              query_ids( i ) = local_query_ids( i );
+                              for ( unsigned int d = 0; d < dim; ++d )
+                                  ref_pts( i, d ) = reference_points( i, d );
+                          } );
+    Kokkos::fence();
+
+    // Communicate the results
+    unsigned int const n_imports =
+        _target_to_source_distributor.getTotalReceiveLength();
+    Kokkos::View<int *, DeviceType> imported_ranks( "imported_ranks",
+                                                    n_imports );
+    Kokkos::View<int *, DeviceType> imported_cell_indices(
+        "imported_cell_indices", n_imports );
+    Kokkos::View<Coordinate * [3], DeviceType> imported_ref_pts(
+        "imported_ref_pts", n_imports );
+    Kokkos::View<unsigned int *, DeviceType> imported_query_ids(
+        "imported_query_ids", n_imports );
+    ExecutionSpace space;
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _target_to_source_distributor, ranks, imported_ranks );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _target_to_source_distributor, _cell_indices,
+        imported_cell_indices );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _target_to_source_distributor, ref_pts, imported_ref_pts );
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+        space, _target_to_source_distributor, query_ids, imported_query_ids );
+
+    ArborX::Details::DistributedTreeImpl<DeviceType>::sortResults(
+        space, imported_query_ids, imported_query_ids, imported_cell_indices,
+        imported_ranks, imported_ref_pts );
+
+    return std::make_tuple( imported_ranks, imported_cell_indices,
+                            imported_ref_pts, imported_query_ids );
+}
+} // namespace DataTransferKit
+
+// Explicit instantiation macro
+#define DTK_STRUCTUREDPOINTSEARCH_INSTANT( NODE )                              \
+    template class StructuredPointSearch<typename NODE::device_type>;
+
+#endif
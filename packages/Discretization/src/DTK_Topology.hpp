@@ -79,66 +79,88 @@ struct HEX_8
 {
     typedef Intrepid2::Impl::Basis_HGRAD_HEX_C1_FEM basis_type;
     typedef Intrepid2::Impl::Hexahedron<8> topo_type;
+    static unsigned int constexpr n_nodes = 8;
+    typedef HEX_8 linear_cell_type;
 };
 
 struct HEX_27
 {
     typedef Intrepid2::Impl::Basis_HGRAD_HEX_C2_FEM basis_type;
     typedef Intrepid2::Impl::Hexahedron<27> topo_type;
+    static unsigned int constexpr n_nodes = 27;
+    typedef HEX_8 linear_cell_type;
 };
 
 struct PYRAMID_5
 {
     typedef Intrepid2::Impl::Basis_HGRAD_PYR_C1_FEM basis_type;
     typedef Intrepid2::Impl::Pyramid<5> topo_type;
+    static unsigned int constexpr n_nodes = 5;
+    typedef PYRAMID_5 linear_cell_type;
 };
 
 struct QUAD_4
 {
     typedef Intrepid2::Impl::Basis_HGRAD_QUAD_C1_FEM basis_type;
     typedef Intrepid2::Impl::Quadrilateral<4> topo_type;
+    static unsigned int constexpr n_nodes = 4;
+    typedef QUAD_4 linear_cell_type;
 };
 
 struct QUAD_9
 {
     typedef Intrepid2::Impl::Basis_HGRAD_QUAD_C2_FEM basis_type;
     typedef Intrepid2::Impl::Quadrilateral<9> topo_type;
+    static unsigned int constexpr n_nodes = 9;
+    typedef QUAD_4 linear_cell_type;
 };
 
 struct TET_4
 {
     typedef Intrepid2::Impl::Basis_HGRAD_TET_C1_FEM basis_type;
     typedef Intrepid2::Impl::Tetrahedron<4> topo_type;
+    static unsigned int constexpr n_nodes = 4;
+    typedef TET_4 linear_cell_type;
 };
 
 struct TET_10
 {
     typedef Intrepid2::Impl::Basis_HGRAD_TET_C2_FEM basis_type;
     typedef Intrepid2::Impl::Tetrahedron<10> topo_type;
+    static unsigned int constexpr n_nodes = 10;
+    typedef TET_4 linear_cell_type;
 };
 
 struct TRI_3
 {
     typedef Intrepid2::Impl::Basis_HGRAD_TRI_C1_FEM basis_type;
     typedef Intrepid2::Impl::Triangle<3> topo_type;
+    static unsigned int constexpr n_nodes = 3;
+    typedef TRI_3 linear_cell_type;
 };
 
 struct TRI_6
 {
     typedef Intrepid2::Impl::Basis_HGRAD_TRI_C2_FEM basis_type;
     typedef Intrepid2::Impl::Triangle<6> topo_type;
+    static unsigned int constexpr n_nodes = 6;
+    typedef TRI_3 linear_cell_type;
 };
 
 struct WEDGE_6
 {
     typedef Intrepid2::Impl::Basis_HGRAD_WEDGE_C1_FEM basis_type;
     typedef Intrepid2::Impl::Wedge<6> topo_type;
+    static unsigned int constexpr n_nodes = 6;
+    typedef WEDGE_6 linear_cell_type;
 };
 
 struct WEDGE_18
 {
     typedef Intrepid2::Impl::Basis_HGRAD_WEDGE_C2_FEM basis_type;
     typedef Intrepid2::Impl::Wedge<18> topo_type;
+    static unsigned int constexpr n_nodes = 18;
+    typedef WEDGE_6 linear_cell_type;
 };
 } // namespace DataTransferKit
 
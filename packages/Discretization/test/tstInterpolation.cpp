@@ -518,6 +518,71 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Interpolation,
     }
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Interpolation,
+                                   two_topo_two_dim_interpolation_matrix,
+                                   DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+    int comm_size;
+    MPI_Comm_size( comm, &comm_size );
+
+    unsigned int constexpr dim = 2;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies;
+    Kokkos::View<unsigned int *, DeviceType> cells;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> coordinates;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> points_coord;
+    std::tie( cell_topologies, cells, coordinates ) =
+        buildMixedMesh<DeviceType>( comm, 2 );
+    points_coord = getPointsCoord2D<DeviceType>( comm );
+    unsigned int const n_points = points_coord.extent( 0 );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+    unsigned int const n_dofs = coordinates.extent( 0 );
+    unsigned int const n_fields = 2;
+    Kokkos::View<DataTransferKit::LocalOrdinal *, DeviceType> cell_dofs_ids(
+        "cell_dofs_ids", cells.extent( 0 ) );
+
+    Kokkos::parallel_for(
+        "initialize_cell_dofs_ids",
+        Kokkos::RangePolicy<ExecutionSpace>( 0, cells.extent( 0 ) ),
+        KOKKOS_LAMBDA( int const i ) { cell_dofs_ids( i ) = cells( i ); } );
+    Kokkos::fence();
+
+    // Evaluate the basis functions once and reuse them for several fields
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies, cells,
+                                            coordinates );
+    DataTransferKit::Interpolation<DeviceType> interpolation(
+        comm, mesh, points_coord, cell_dofs_ids, DTK_HGRAD, true );
+
+    unsigned int const query_offset = 3 * ( ( comm_rank + 1 ) % comm_size );
+    for ( unsigned int shift = 0; shift < 2; ++shift )
+    {
+        // We set X = x + y + 2*field_id + shift with field_id = 0 or 1
+        Kokkos::View<double **, DeviceType> X( "X", n_dofs, n_fields );
+        Kokkos::parallel_for(
+            "initialize_X", Kokkos::RangePolicy<ExecutionSpace>( 0, n_dofs ),
+            KOKKOS_LAMBDA( int const i ) {
+                for ( unsigned int j = 0; j < n_fields; ++j )
+                {
+                    X( i, j ) = shift;
+                    for ( unsigned int d = 0; d < dim; ++d )
+                        X( i, j ) += j + coordinates( i, d );
+                }
+            } );
+        Kokkos::fence();
+
+        Kokkos::View<double **, DeviceType> Y( "Y", n_points, n_fields );
+        interpolation.apply( X, Y );
+
+        std::array<double, 4> ref_sol = {
+            {query_offset + shift + 1.5, query_offset + shift + 2.5,
+             query_offset + shift + 3., query_offset + shift + 3.}};
+        checkFieldValue<dim, 4>( ref_sol, Y, success, out );
+    }
+}
+
 // Include the test macros.
 #include "DataTransferKit_ETIHelperMacros.h"
 
@@ -532,6 +597,9 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Interpolation,
         Interpolation, one_topo_one_fe_three_dim_hdiv, DeviceType##NODE )      \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT(                                      \
         Interpolation, one_topo_one_fe_three_dim_point_not_found,              \
+        DeviceType##NODE )                                                     \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT(                                      \
+        Interpolation, two_topo_two_dim_interpolation_matrix,                  \
         DeviceType##NODE )
 
 // Demangle the types
@@ -15,10 +15,17 @@
 #include <Teuchos_UnitTestHarness.hpp>
 
 #include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
 
-// We only test DTK_HEX_8 and DTK_QUAD_4. Testing all the topologies would
-// require a lot of code (need to create a bunch of meshes) and the only
-// difference in the search is the template parameters in the Functor.
+// We only test DTK_HEX_8, DTK_QUAD_4, DTK_TET_4, and DTK_QUAD_9. Testing all
+// the topologies would require a lot of code (need to create a bunch of meshes)
+// and the only difference in the search is the template parameters in the
+// Functor. DTK_TET_4 is tested because its reference points are computed in
+// closed form instead of using the Newton solver. DTK_QUAD_9 is tested because
+// the candidates of high-order cells are first checked against the cell
+// defined by their vertices.
 
 TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointInCell, hex_8, DeviceType )
 {
@@ -245,6 +252,339 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointInCell, quad_4, DeviceType )
     }
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointInCell, quad_4_mesh, DeviceType )
+{
+    // Same test as above but the nodes of the cells are read through the
+    // connectivity of the mesh.
+    unsigned int constexpr dim = 2;
+    DTK_CellTopology cell_topology = DTK_QUAD_4;
+    unsigned int constexpr n_ref_pts = 5;
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        reference_points( "ref_pts", n_ref_pts );
+    Kokkos::View<bool *, DeviceType> point_in_cell( "pt_in_cell", n_ref_pts );
+    // Physical points are (1.5, 0.5) and (2.5, 0.3). The first point is
+    // duplicate three times and the second one two times.
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        physical_points( "phys_pts", n_ref_pts );
+    physical_points( 0, 0 ) = 1.5;
+    physical_points( 0, 1 ) = 0.5;
+    physical_points( 1, 0 ) = 1.5;
+    physical_points( 1, 1 ) = 0.5;
+    physical_points( 2, 0 ) = 1.5;
+    physical_points( 2, 1 ) = 0.5;
+    physical_points( 3, 0 ) = 2.5;
+    physical_points( 3, 1 ) = 0.3;
+    physical_points( 4, 0 ) = 2.5;
+    physical_points( 4, 1 ) = 0.3;
+    // Coordinates of the nodes. The nodes are shared by the cells.
+    unsigned int constexpr n_nodes = 8;
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        nodes_coordinates( "nodes_coordinates", n_nodes );
+    for ( unsigned int i = 0; i < 4; ++i )
+    {
+        nodes_coordinates( i, 0 ) = i;
+        nodes_coordinates( i, 1 ) = 0.;
+        nodes_coordinates( i + 4, 0 ) = i;
+        nodes_coordinates( i + 4, 1 ) = 1.;
+    }
+    // Connectivity of the cells
+    unsigned int constexpr n_cells = 3;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies(
+        "cell_topologies", n_cells );
+    Kokkos::View<unsigned int *, DeviceType> cells( "cells", 4 * n_cells );
+    Kokkos::View<unsigned int *, DeviceType> node_offset( "node_offset",
+                                                          n_cells );
+    for ( unsigned int i = 0; i < n_cells; ++i )
+    {
+        cell_topologies( i ) = cell_topology;
+        node_offset( i ) = 4 * i;
+        cells( 4 * i ) = i;
+        cells( 4 * i + 1 ) = i + 1;
+        cells( 4 * i + 2 ) = i + 5;
+        cells( 4 * i + 3 ) = i + 4;
+    }
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies, cells,
+                                            nodes_coordinates );
+    // Coarse search output: cells
+    Kokkos::View<int *, DeviceType> coarse_srch_cells( "coarse_srch_cells", 5 );
+    coarse_srch_cells( 0 ) = 0;
+    coarse_srch_cells( 1 ) = 1;
+    coarse_srch_cells( 2 ) = 2;
+    coarse_srch_cells( 3 ) = 1;
+    coarse_srch_cells( 4 ) = 2;
+
+    DataTransferKit::PointInCell<DeviceType>::search(
+        mesh, node_offset, physical_points, coarse_srch_cells, cell_topology,
+        reference_points, point_in_cell );
+
+    auto reference_points_host = Kokkos::create_mirror_view( reference_points );
+    Kokkos::deep_copy( reference_points_host, reference_points );
+    auto point_in_cell_host = Kokkos::create_mirror_view( point_in_cell );
+    Kokkos::deep_copy( point_in_cell_host, point_in_cell );
+
+    std::vector<std::array<double, dim>> reference_points_ref = {
+        {{2., 0.}}, {{0., 0.}}, {{-2., 0.}}, {{2., -0.4}}, {{0., -0.4}}};
+    std::vector<bool> point_in_cell_ref = {false, true, false, false, true};
+
+    double const tol = 1e-14;
+    for ( unsigned int i = 0; i < n_ref_pts; ++i )
+    {
+        for ( unsigned int j = 0; j < dim; ++j )
+            TEST_ASSERT( std::abs( reference_points_host( i, j ) -
+                                   reference_points_ref[i][j] ) < tol );
+        TEST_EQUALITY( point_in_cell_host( i ), point_in_cell_ref[i] );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointInCell, tet_4, DeviceType )
+{
+    // The map of a tetrahedron is affine so the reference points are computed
+    // in closed form.
+    unsigned int constexpr dim = 3;
+    DTK_CellTopology cell_topology = DTK_TET_4;
+    unsigned int constexpr n_ref_pts = 4;
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        reference_points( "ref_pts", n_ref_pts );
+    Kokkos::View<bool *, DeviceType> point_in_cell( "pt_in_cell", n_ref_pts );
+    // Physical points are (1.5, 1.5, 1.5) and (0.8, 0.5, 0.2). Each point is
+    // searched in both cells.
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        physical_points( "phys_pts", n_ref_pts );
+    physical_points( 0, 0 ) = 1.5;
+    physical_points( 0, 1 ) = 1.5;
+    physical_points( 0, 2 ) = 1.5;
+    physical_points( 1, 0 ) = 0.8;
+    physical_points( 1, 1 ) = 0.5;
+    physical_points( 1, 2 ) = 0.2;
+    physical_points( 2, 0 ) = 0.8;
+    physical_points( 2, 1 ) = 0.5;
+    physical_points( 2, 2 ) = 0.2;
+    physical_points( 3, 0 ) = 1.5;
+    physical_points( 3, 1 ) = 1.5;
+    physical_points( 3, 2 ) = 1.5;
+    // Vertices of the cells
+    Kokkos::View<DataTransferKit::Coordinate * * [dim], DeviceType> cells(
+        "cell_nodes", 2, 4 );
+    // First cell
+    cells( 0, 0, 0 ) = 1.;
+    cells( 0, 0, 1 ) = 1.;
+    cells( 0, 0, 2 ) = 1.;
+    cells( 0, 1, 0 ) = 3.;
+    cells( 0, 1, 1 ) = 1.;
+    cells( 0, 1, 2 ) = 1.;
+    cells( 0, 2, 0 ) = 1.;
+    cells( 0, 2, 1 ) = 3.;
+    cells( 0, 2, 2 ) = 1.;
+    cells( 0, 3, 0 ) = 1.;
+    cells( 0, 3, 1 ) = 1.;
+    cells( 0, 3, 2 ) = 3.;
+    // Second cell
+    cells( 1, 0, 0 ) = 0.;
+    cells( 1, 0, 1 ) = 0.;
+    cells( 1, 0, 2 ) = 0.;
+    cells( 1, 1, 0 ) = 1.;
+    cells( 1, 1, 1 ) = 0.;
+    cells( 1, 1, 2 ) = 0.;
+    cells( 1, 2, 0 ) = 1.;
+    cells( 1, 2, 1 ) = 1.;
+    cells( 1, 2, 2 ) = 0.;
+    cells( 1, 3, 0 ) = 1.;
+    cells( 1, 3, 1 ) = 1.;
+    cells( 1, 3, 2 ) = 1.;
+    // Coarse search output: cells
+    Kokkos::View<int *, DeviceType> coarse_srch_cells( "coarse_srch_cells", 4 );
+    coarse_srch_cells( 0 ) = 0;
+    coarse_srch_cells( 1 ) = 1;
+    coarse_srch_cells( 2 ) = 0;
+    coarse_srch_cells( 3 ) = 1;
+
+    DataTransferKit::PointInCell<DeviceType>::search(
+        physical_points, cells, coarse_srch_cells, cell_topology,
+        reference_points, point_in_cell );
+
+    auto reference_points_host = Kokkos::create_mirror_view( reference_points );
+    Kokkos::deep_copy( reference_points_host, reference_points );
+    auto point_in_cell_host = Kokkos::create_mirror_view( point_in_cell );
+    Kokkos::deep_copy( point_in_cell_host, point_in_cell );
+
+    std::vector<std::array<double, dim>> reference_points_ref = {
+        {{0.25, 0.25, 0.25}},
+        {{0.3, 0.3, 0.2}},
+        {{-0.1, -0.25, -0.4}},
+        {{0., 0., 1.5}}};
+    std::vector<bool> point_in_cell_ref = {true, true, false, false};
+
+    double const tol = 1e-14;
+    for ( unsigned int i = 0; i < n_ref_pts; ++i )
+    {
+        for ( unsigned int j = 0; j < dim; ++j )
+            TEST_ASSERT( std::abs( reference_points_host( i, j ) -
+                                   reference_points_ref[i][j] ) < tol );
+        TEST_EQUALITY( point_in_cell_host( i ), point_in_cell_ref[i] );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointInCell, quad_9, DeviceType )
+{
+    // The first cell is [0, 1]x[0, 1]. The second cell is [1, 2]x[0, 1] but
+    // the middle node of the top edge is moved to (1.5, 1.1) so the cell is
+    // curved. Candidates far from the cells are rejected using the cell
+    // defined by the vertices.
+    unsigned int constexpr dim = 2;
+    DTK_CellTopology cell_topology = DTK_QUAD_9;
+    unsigned int constexpr n_ref_pts = 4;
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        reference_points( "ref_pts", n_ref_pts );
+    Kokkos::View<bool *, DeviceType> point_in_cell( "pt_in_cell", n_ref_pts );
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        physical_points( "phys_pts", n_ref_pts );
+    physical_points( 0, 0 ) = 0.5;
+    physical_points( 0, 1 ) = 0.5;
+    // This point is outside of the cell defined by the vertices of the second
+    // cell but inside the curved cell.
+    physical_points( 1, 0 ) = 1.5;
+    physical_points( 1, 1 ) = 1.04;
+    physical_points( 2, 0 ) = 0.5;
+    physical_points( 2, 1 ) = 1.5;
+    physical_points( 3, 0 ) = 1.5;
+    physical_points( 3, 1 ) = 1.04;
+    // Vertices of the cells
+    Kokkos::View<DataTransferKit::Coordinate * * [dim], DeviceType> cells(
+        "cell_nodes", 2, 9 );
+    std::array<std::array<double, dim>, 9> ref_nodes = {
+        {{{-1., -1.}},
+         {{1., -1.}},
+         {{1., 1.}},
+         {{-1., 1.}},
+         {{0., -1.}},
+         {{1., 0.}},
+         {{0., 1.}},
+         {{-1., 0.}},
+         {{0., 0.}}}};
+    for ( unsigned int i = 0; i < 2; ++i )
+        for ( unsigned int n = 0; n < 9; ++n )
+        {
+            cells( i, n, 0 ) = i + 0.5 * ( ref_nodes[n][0] + 1. );
+            cells( i, n, 1 ) = 0.5 * ( ref_nodes[n][1] + 1. );
+        }
+    cells( 1, 6, 1 ) = 1.1;
+    // Coarse search output: cells
+    Kokkos::View<int *, DeviceType> coarse_srch_cells( "coarse_srch_cells", 4 );
+    coarse_srch_cells( 0 ) = 0;
+    coarse_srch_cells( 1 ) = 1;
+    coarse_srch_cells( 2 ) = 0;
+    coarse_srch_cells( 3 ) = 0;
+
+    DataTransferKit::PointInCell<DeviceType>::search(
+        physical_points, cells, coarse_srch_cells, cell_topology,
+        reference_points, point_in_cell );
+
+    auto reference_points_host = Kokkos::create_mirror_view( reference_points );
+    Kokkos::deep_copy( reference_points_host, reference_points );
+    auto point_in_cell_host = Kokkos::create_mirror_view( point_in_cell );
+    Kokkos::deep_copy( point_in_cell_host, point_in_cell );
+
+    std::vector<bool> point_in_cell_ref = {true, true, false, false};
+    for ( unsigned int i = 0; i < n_ref_pts; ++i )
+        TEST_EQUALITY( point_in_cell_host( i ), point_in_cell_ref[i] );
+
+    double const tol = 1e-12;
+    TEST_ASSERT( std::abs( reference_points_host( 0, 0 ) ) < tol );
+    TEST_ASSERT( std::abs( reference_points_host( 0, 1 ) ) < tol );
+    // The reference point of the curved cell is on the line x = 1.5 and
+    // above the cell defined by the vertices.
+    TEST_ASSERT( std::abs( reference_points_host( 1, 0 ) ) < tol );
+    TEST_ASSERT( reference_points_host( 1, 1 ) > 0.8 );
+    TEST_ASSERT( reference_points_host( 1, 1 ) < 1. );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointInCell, initial_guess_fallback,
+                                   DeviceType )
+{
+    // The cell is the unit cube with the vertex (1, 1, 1) moved to
+    // (1.3, 1.2, 1.1) so its map is not affine and the reference points are
+    // computed with the Newton solver. The second point is outside of the
+    // unit cube but inside the cell. When the solver does not converge from
+    // the initial guess, here NaN, the search must give the same results as
+    // the search that starts from the center of the cell.
+    unsigned int constexpr dim = 3;
+    DTK_CellTopology cell_topology = DTK_HEX_8;
+    unsigned int constexpr n_ref_pts = 3;
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        physical_points( "phys_pts", n_ref_pts );
+    physical_points( 0, 0 ) = 0.5;
+    physical_points( 0, 1 ) = 0.5;
+    physical_points( 0, 2 ) = 0.5;
+    physical_points( 1, 0 ) = 1.1;
+    physical_points( 1, 1 ) = 0.9;
+    physical_points( 1, 2 ) = 0.8;
+    physical_points( 2, 0 ) = 1.5;
+    physical_points( 2, 1 ) = 0.5;
+    physical_points( 2, 2 ) = 0.5;
+    // Vertices of the cell
+    Kokkos::View<DataTransferKit::Coordinate * * [dim], DeviceType> cells(
+        "cell_nodes", 1, 8 );
+    std::array<std::array<double, dim>, 8> vertices = {{{{0., 0., 0.}},
+                                                        {{1., 0., 0.}},
+                                                        {{1., 1., 0.}},
+                                                        {{0., 1., 0.}},
+                                                        {{0., 0., 1.}},
+                                                        {{1., 0., 1.}},
+                                                        {{1.3, 1.2, 1.1}},
+                                                        {{0., 1., 1.}}}};
+    for ( unsigned int n = 0; n < 8; ++n )
+        for ( unsigned int d = 0; d < dim; ++d )
+            cells( 0, n, d ) = vertices[n][d];
+    // Coarse search output: cells
+    Kokkos::View<int *, DeviceType> coarse_srch_cells( "coarse_srch_cells",
+                                                       n_ref_pts );
+    Kokkos::deep_copy( coarse_srch_cells, 0 );
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        reference_points( "ref_pts", n_ref_pts );
+    Kokkos::View<bool *, DeviceType> point_in_cell( "pt_in_cell", n_ref_pts );
+    DataTransferKit::PointInCell<DeviceType>::search(
+        physical_points, cells, coarse_srch_cells, cell_topology,
+        reference_points, point_in_cell );
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        guessed_reference_points( "guessed_ref_pts", n_ref_pts );
+    Kokkos::deep_copy( guessed_reference_points,
+                       std::numeric_limits<double>::quiet_NaN() );
+    Kokkos::View<bool *, DeviceType> guessed_point_in_cell(
+        "guessed_pt_in_cell", n_ref_pts );
+    DataTransferKit::PointInCell<DeviceType>::search(
+        physical_points, cells, coarse_srch_cells, cell_topology,
+        guessed_reference_points, guessed_point_in_cell, true );
+
+    auto reference_points_host = Kokkos::create_mirror_view( reference_points );
+    Kokkos::deep_copy( reference_points_host, reference_points );
+    auto point_in_cell_host = Kokkos::create_mirror_view( point_in_cell );
+    Kokkos::deep_copy( point_in_cell_host, point_in_cell );
+    auto guessed_reference_points_host =
+        Kokkos::create_mirror_view( guessed_reference_points );
+    Kokkos::deep_copy( guessed_reference_points_host,
+                       guessed_reference_points );
+    auto guessed_point_in_cell_host =
+        Kokkos::create_mirror_view( guessed_point_in_cell );
+    Kokkos::deep_copy( guessed_point_in_cell_host, guessed_point_in_cell );
+
+    std::vector<bool> point_in_cell_ref = {true, true, false};
+    double const tol = 1e-12;
+    for ( unsigned int i = 0; i < n_ref_pts; ++i )
+    {
+        TEST_EQUALITY( point_in_cell_host( i ), point_in_cell_ref[i] );
+        TEST_EQUALITY( guessed_point_in_cell_host( i ), point_in_cell_ref[i] );
+        for ( unsigned int j = 0; j < dim; ++j )
+            TEST_ASSERT( std::abs( guessed_reference_points_host( i, j ) -
+                                   reference_points_host( i, j ) ) < tol );
+    }
+}
+
 // Include the test macros.
 #include "DataTransferKit_ETIHelperMacros.h"
 
@@ -255,6 +595,17 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointInCell, quad_4, DeviceType )
                                           DeviceType##NODE )                   \
     using DeviceType##NODE = typename NODE::device_type;                       \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointInCell, quad_4,                 \
+                                          DeviceType##NODE )                   \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointInCell, quad_4_mesh,            \
+                                          DeviceType##NODE )                   \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointInCell, tet_4,                  \
+                                          DeviceType##NODE )                   \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointInCell, quad_9,                 \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointInCell, initial_guess_fallback, \
                                           DeviceType##NODE )
 
 // Demangle the types
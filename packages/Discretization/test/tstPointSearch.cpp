@@ -12,9 +12,13 @@
 #include "MeshGenerator.hpp"
 #include <DTK_Mesh.hpp>
 #include <DTK_PointSearch.hpp>
+#include <DTK_PointSearch_def.hpp> // internal::balanceQueries
+#include <DTK_SourceMeshIndex.hpp>
 
 #include <Teuchos_UnitTestHarness.hpp>
 
+#include <algorithm>
+
 template <typename DeviceType>
 Kokkos::View<DataTransferKit::Coordinate *[3], DeviceType>
 getPointsCoord3D( MPI_Comm comm ) {
@@ -158,6 +162,74 @@ void checkReferencePoints(
     }
 }
 
+// Check that two searches found the same points in the same cells. The order
+// of the results associated to the same query id does not matter.
+template <typename DeviceType>
+void checkSameResults(
+    DataTransferKit::PointSearch<DeviceType> const &search,
+    DataTransferKit::PointSearch<DeviceType> const &ref_search, bool &success,
+    Teuchos::FancyOStream &out )
+{
+    using Result = std::tuple<unsigned int, int, int,
+                              std::array<DataTransferKit::Coordinate, 3>>;
+    auto get_results = []( DataTransferKit::PointSearch<DeviceType> const
+                               &pt_search ) {
+        Kokkos::View<int *, DeviceType> ranks;
+        Kokkos::View<int *, DeviceType> cell_indices;
+        Kokkos::View<DataTransferKit::Coordinate * [3], DeviceType>
+            reference_points;
+        Kokkos::View<unsigned int *, DeviceType> query_ids;
+        std::tie( ranks, cell_indices, reference_points, query_ids ) =
+            pt_search.getSearchResults();
+        auto ranks_host = Kokkos::create_mirror_view( ranks );
+        Kokkos::deep_copy( ranks_host, ranks );
+        auto cell_indices_host = Kokkos::create_mirror_view( cell_indices );
+        Kokkos::deep_copy( cell_indices_host, cell_indices );
+        auto reference_points_host =
+            Kokkos::create_mirror_view( reference_points );
+        Kokkos::deep_copy( reference_points_host, reference_points );
+        auto query_ids_host = Kokkos::create_mirror_view( query_ids );
+        Kokkos::deep_copy( query_ids_host, query_ids );
+
+        std::vector<Result> results;
+        for ( unsigned int i = 0; i < query_ids_host.extent( 0 ); ++i )
+            results.emplace_back(
+                query_ids_host( i ), ranks_host( i ), cell_indices_host( i ),
+                std::array<DataTransferKit::Coordinate, 3>{
+                    {reference_points_host( i, 0 ),
+                     reference_points_host( i, 1 ),
+                     reference_points_host( i, 2 )}} );
+        std::sort( results.begin(), results.end(),
+                   []( Result const &a, Result const &b ) {
+                       return std::make_tuple( std::get<0>( a ),
+                                               std::get<1>( a ),
+                                               std::get<2>( a ) ) <
+                              std::make_tuple( std::get<0>( b ),
+                                               std::get<1>( b ),
+                                               std::get<2>( b ) );
+                   } );
+
+        return results;
+    };
+
+    auto const results = get_results( search );
+    auto const ref_results = get_results( ref_search );
+    TEST_EQUALITY( results.size(), ref_results.size() );
+    for ( unsigned int i = 0; i < ref_results.size(); ++i )
+    {
+        TEST_EQUALITY( std::get<0>( results[i] ),
+                       std::get<0>( ref_results[i] ) );
+        TEST_EQUALITY( std::get<1>( results[i] ),
+                       std::get<1>( ref_results[i] ) );
+        TEST_EQUALITY( std::get<2>( results[i] ),
+                       std::get<2>( ref_results[i] ) );
+        for ( unsigned int d = 0; d < 3; ++d )
+            TEST_COMPARE( std::abs( std::get<3>( results[i] )[d] -
+                                    std::get<3>( ref_results[i] )[d] ),
+                          <, 1e-10 );
+    }
+}
+
 TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, one_topo_three_dim, DeviceType )
 {
     MPI_Comm comm = MPI_COMM_WORLD;
@@ -451,6 +523,438 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, two_topo_two_dim, DeviceType )
                                            success, out );
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, shared_source_mesh_index,
+                                   DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+    unsigned int constexpr dim = 3;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view;
+    Kokkos::View<unsigned int *, DeviceType> cells;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> coordinates;
+    std::vector<unsigned int> n_subdivisions = {{5, 5, 3}};
+    std::tie( cell_topologies_view, cells, coordinates ) =
+        buildStructuredMesh<DeviceType>( comm, n_subdivisions );
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies_view, cells,
+                                            coordinates );
+
+    // Build the index once and use it for two different sets of points
+    auto source_mesh_index =
+        std::make_shared<DataTransferKit::SourceMeshIndex<DeviceType> const>(
+            comm, mesh );
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType> points_coord =
+        getPointsCoord3D<DeviceType>( comm );
+    DataTransferKit::PointSearch<DeviceType> pt_search( source_mesh_index,
+                                                        points_coord );
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        far_points_coord( "far_points_coord", 1 );
+    Kokkos::deep_copy( far_points_coord, 10000. );
+    DataTransferKit::PointSearch<DeviceType> far_pt_search( source_mesh_index,
+                                                            far_points_coord );
+
+    // The results should be the same as the ones obtained without sharing
+    // the index
+    DataTransferKit::PointSearch<DeviceType> ref_pt_search( comm, mesh,
+                                                            points_coord );
+
+    Kokkos::View<int *, DeviceType> ranks;
+    Kokkos::View<int *, DeviceType> cell_indices;
+    Kokkos::View<DataTransferKit::Coordinate * [3], DeviceType>
+        reference_points;
+    Kokkos::View<unsigned int *, DeviceType> query_ids;
+    std::tie( ranks, cell_indices, reference_points, query_ids ) =
+        pt_search.getSearchResults();
+    Kokkos::View<int *, DeviceType> ref_ranks;
+    Kokkos::View<int *, DeviceType> ref_cell_indices;
+    Kokkos::View<DataTransferKit::Coordinate * [3], DeviceType>
+        ref_reference_points;
+    Kokkos::View<unsigned int *, DeviceType> ref_query_ids;
+    std::tie( ref_ranks, ref_cell_indices, ref_reference_points,
+              ref_query_ids ) = ref_pt_search.getSearchResults();
+
+    TEST_EQUALITY( query_ids.extent( 0 ), ref_query_ids.extent( 0 ) );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    auto ref_ranks_host = Kokkos::create_mirror_view( ref_ranks );
+    Kokkos::deep_copy( ref_ranks_host, ref_ranks );
+    auto cell_indices_host = Kokkos::create_mirror_view( cell_indices );
+    Kokkos::deep_copy( cell_indices_host, cell_indices );
+    auto ref_cell_indices_host = Kokkos::create_mirror_view( ref_cell_indices );
+    Kokkos::deep_copy( ref_cell_indices_host, ref_cell_indices );
+    auto query_ids_host = Kokkos::create_mirror_view( query_ids );
+    Kokkos::deep_copy( query_ids_host, query_ids );
+    auto ref_query_ids_host = Kokkos::create_mirror_view( ref_query_ids );
+    Kokkos::deep_copy( ref_query_ids_host, ref_query_ids );
+    for ( unsigned int i = 0; i < ref_query_ids_host.extent( 0 ); ++i )
+    {
+        TEST_EQUALITY( ranks_host( i ), ref_ranks_host( i ) );
+        TEST_EQUALITY( cell_indices_host( i ), ref_cell_indices_host( i ) );
+        TEST_EQUALITY( query_ids_host( i ), ref_query_ids_host( i ) );
+    }
+
+    std::tie( ranks, cell_indices, reference_points, query_ids ) =
+        far_pt_search.getSearchResults();
+    TEST_EQUALITY( query_ids.extent( 0 ), 0 );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, update, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    unsigned int constexpr dim = 3;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view;
+    Kokkos::View<unsigned int *, DeviceType> cells;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> coordinates;
+    std::vector<unsigned int> n_subdivisions = {{5, 5, 3}};
+    std::tie( cell_topologies_view, cells, coordinates ) =
+        buildStructuredMesh<DeviceType>( comm, n_subdivisions );
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies_view, cells,
+                                            coordinates );
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType> points_coord =
+        getPointsCoord3D<DeviceType>( comm );
+    DataTransferKit::PointSearch<DeviceType> pt_search( comm, mesh,
+                                                        points_coord );
+
+    // Move the first point inside its cell and the second point to another
+    // cell. The other points do not move.
+    unsigned int const n_points = points_coord.extent( 0 );
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        moved_points_coord( "moved_points_coord", n_points );
+    auto moved_points_coord_host =
+        Kokkos::create_mirror_view( moved_points_coord );
+    auto points_coord_host = Kokkos::create_mirror_view( points_coord );
+    Kokkos::deep_copy( points_coord_host, points_coord );
+    Kokkos::deep_copy( moved_points_coord_host, points_coord_host );
+    if ( n_points > 0 )
+    {
+        for ( unsigned int d = 0; d < dim; ++d )
+            moved_points_coord_host( 0, d ) += 0.1;
+        moved_points_coord_host( 1, 0 ) += 1.;
+    }
+    Kokkos::deep_copy( moved_points_coord, moved_points_coord_host );
+
+    pt_search.update( moved_points_coord );
+
+    // The results should be the same as the ones of a new search
+    DataTransferKit::PointSearch<DeviceType> ref_pt_search(
+        comm, mesh, moved_points_coord );
+
+    checkSameResults( pt_search, ref_pt_search, success, out );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, refit_source_mesh_index,
+                                   DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    unsigned int constexpr dim = 3;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view;
+    Kokkos::View<unsigned int *, DeviceType> cells;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> coordinates;
+    std::vector<unsigned int> n_subdivisions = {{5, 5, 3}};
+    std::tie( cell_topologies_view, cells, coordinates ) =
+        buildStructuredMesh<DeviceType>( comm, n_subdivisions );
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies_view, cells,
+                                            coordinates );
+    auto source_mesh_index =
+        std::make_shared<DataTransferKit::SourceMeshIndex<DeviceType>>(
+            comm, mesh, 0.1 );
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType> points_coord =
+        getPointsCoord3D<DeviceType>( comm );
+
+    for ( double shift : {0.01, 0.5} )
+    {
+        // Move the mesh
+        unsigned int const n_nodes = coordinates.extent( 0 );
+        Kokkos::View<DataTransferKit::Coordinate **, DeviceType>
+            moved_coordinates( "moved_coordinates", n_nodes, dim );
+        using ExecutionSpace = typename DeviceType::execution_space;
+        Kokkos::parallel_for(
+            "move_nodes", Kokkos::RangePolicy<ExecutionSpace>( 0, n_nodes ),
+            KOKKOS_LAMBDA( int const i ) {
+                for ( unsigned int d = 0; d < dim; ++d )
+                    moved_coordinates( i, d ) = coordinates( i, d ) + shift;
+            } );
+        Kokkos::fence();
+
+        // The boxes stored in the tree are large enough for a small
+        // displacement but the tree needs to be rebuilt for a large one.
+        bool const rebuilt = source_mesh_index->refit( moved_coordinates );
+        TEST_EQUALITY( rebuilt, shift > 0.1 );
+
+        // The results should be the same as the ones obtained with a new
+        // index
+        DataTransferKit::PointSearch<DeviceType> pt_search( source_mesh_index,
+                                                            points_coord );
+        DataTransferKit::Mesh<DeviceType> moved_mesh(
+            cell_topologies_view, cells, moved_coordinates );
+        DataTransferKit::PointSearch<DeviceType> ref_pt_search(
+            comm, moved_mesh, points_coord );
+        checkSameResults( pt_search, ref_pt_search, success, out );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, refit_large_margin,
+                                   DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    unsigned int constexpr dim = 3;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view;
+    Kokkos::View<unsigned int *, DeviceType> cells;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> coordinates;
+    std::vector<unsigned int> n_subdivisions = {{5, 5, 3}};
+    std::tie( cell_topologies_view, cells, coordinates ) =
+        buildStructuredMesh<DeviceType>( comm, n_subdivisions );
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies_view, cells,
+                                            coordinates );
+    // With a margin of 0.25, the volume of the enlarged boxes is 3.375 times
+    // the volume of the boxes of the cells. The margin must not be taken into
+    // account when the quality of the tree is checked.
+    DataTransferKit::SourceMeshIndex<DeviceType> source_mesh_index( comm, mesh,
+                                                                    0.25 );
+
+    // The mesh does not move
+    unsigned int const n_nodes = coordinates.extent( 0 );
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> same_coordinates(
+        "same_coordinates", n_nodes, dim );
+    Kokkos::deep_copy( same_coordinates, coordinates );
+    TEST_ASSERT( !source_mesh_index.refit( same_coordinates ) );
+    TEST_ASSERT( !source_mesh_index.refit( same_coordinates, 0.9 ) );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, kdop_filter, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    unsigned int constexpr dim = 3;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view;
+    Kokkos::View<unsigned int *, DeviceType> cells;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> coordinates;
+    std::vector<unsigned int> n_subdivisions = {{5, 5, 3}};
+    std::tie( cell_topologies_view, cells, coordinates ) =
+        buildStructuredMesh<DeviceType>( comm, n_subdivisions );
+
+    // Skew the mesh so that the bounding boxes of the cells overlap
+    unsigned int const n_nodes = coordinates.extent( 0 );
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> skewed_coordinates(
+        "skewed_coordinates", n_nodes, dim );
+    using ExecutionSpace = typename DeviceType::execution_space;
+    Kokkos::parallel_for(
+        "skew_nodes", Kokkos::RangePolicy<ExecutionSpace>( 0, n_nodes ),
+        KOKKOS_LAMBDA( int const i ) {
+            skewed_coordinates( i, 0 ) =
+                coordinates( i, 0 ) + 0.8 * coordinates( i, 1 );
+            skewed_coordinates( i, 1 ) = coordinates( i, 1 );
+            skewed_coordinates( i, 2 ) =
+                coordinates( i, 2 ) + 0.5 * coordinates( i, 0 );
+        } );
+    Kokkos::fence();
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies_view, cells,
+                                            skewed_coordinates );
+
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType> points_coord =
+        getPointsCoord3D<DeviceType>( comm );
+
+    // The results should be the same with or without the k-DOPs
+    auto source_mesh_index =
+        std::make_shared<DataTransferKit::SourceMeshIndex<DeviceType> const>(
+            comm, mesh, 0., true );
+    DataTransferKit::PointSearch<DeviceType> pt_search( source_mesh_index,
+                                                        points_coord );
+    DataTransferKit::PointSearch<DeviceType> ref_pt_search( comm, mesh,
+                                                            points_coord );
+    checkSameResults( pt_search, ref_pt_search, success, out );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, unique_results, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    unsigned int constexpr dim = 3;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view;
+    Kokkos::View<unsigned int *, DeviceType> cells;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> coordinates;
+    std::vector<unsigned int> n_subdivisions = {{5, 5, 3}};
+    std::tie( cell_topologies_view, cells, coordinates ) =
+        buildStructuredMesh<DeviceType>( comm, n_subdivisions );
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies_view, cells,
+                                            coordinates );
+
+    // Some of the points are on faces, edges, and vertices so they are found
+    // in several cells when the results are not unique.
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType> points_coord =
+        getPointsCoord3D<DeviceType>( comm );
+    DataTransferKit::PointSearch<DeviceType> pt_search( comm, mesh,
+                                                        points_coord, true );
+    DataTransferKit::PointSearch<DeviceType> ref_pt_search( comm, mesh,
+                                                            points_coord );
+
+    // The results are sent back to the processors owning the points and are
+    // sorted by query id.
+    using Result = std::tuple<unsigned int, int, int>;
+    auto get_results = []( DataTransferKit::PointSearch<DeviceType> const
+                               &search ) {
+        Kokkos::View<int *, DeviceType> ranks;
+        Kokkos::View<int *, DeviceType> cell_indices;
+        Kokkos::View<DataTransferKit::Coordinate * [3], DeviceType>
+            reference_points;
+        Kokkos::View<unsigned int *, DeviceType> query_ids;
+        std::tie( ranks, cell_indices, reference_points, query_ids ) =
+            search.getSearchResults();
+        auto ranks_host = Kokkos::create_mirror_view( ranks );
+        Kokkos::deep_copy( ranks_host, ranks );
+        auto cell_indices_host = Kokkos::create_mirror_view( cell_indices );
+        Kokkos::deep_copy( cell_indices_host, cell_indices );
+        auto query_ids_host = Kokkos::create_mirror_view( query_ids );
+        Kokkos::deep_copy( query_ids_host, query_ids );
+        std::vector<Result> results;
+        for ( unsigned int i = 0; i < query_ids_host.extent( 0 ); ++i )
+            results.emplace_back( query_ids_host( i ), ranks_host( i ),
+                                  cell_indices_host( i ) );
+        std::sort( results.begin(), results.end() );
+        return results;
+    };
+    auto const results = get_results( pt_search );
+    auto const ref_results = get_results( ref_pt_search );
+
+    // The reference search finds some points several times
+    int local_has_duplicates = 0;
+    for ( unsigned int i = 1; i < ref_results.size(); ++i )
+        if ( std::get<0>( ref_results[i] ) ==
+             std::get<0>( ref_results[i - 1] ) )
+            local_has_duplicates = 1;
+    int has_duplicates = 0;
+    MPI_Allreduce( &local_has_duplicates, &has_duplicates, 1, MPI_INT,
+                   MPI_MAX, comm );
+    TEST_EQUALITY( has_duplicates, 1 );
+
+    // Every point is found once, in the cell with the lowest (rank, cell
+    // index) pair among the ones found by the reference search
+    std::vector<Result> expected_results;
+    for ( unsigned int i = 0; i < ref_results.size(); ++i )
+        if ( ( i == 0 ) || ( std::get<0>( ref_results[i] ) !=
+                             std::get<0>( ref_results[i - 1] ) ) )
+            expected_results.push_back( ref_results[i] );
+    TEST_EQUALITY( results.size(), expected_results.size() );
+    for ( unsigned int i = 0; i < expected_results.size(); ++i )
+    {
+        TEST_EQUALITY( std::get<0>( results[i] ),
+                       std::get<0>( expected_results[i] ) );
+        TEST_EQUALITY( std::get<1>( results[i] ),
+                       std::get<1>( expected_results[i] ) );
+        TEST_EQUALITY( std::get<2>( results[i] ),
+                       std::get<2>( expected_results[i] ) );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, balance_queries, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    unsigned int constexpr dim = 3;
+    Kokkos::View<DTK_CellTopology *, DeviceType> cell_topologies_view;
+    Kokkos::View<unsigned int *, DeviceType> cells;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> coordinates;
+    std::vector<unsigned int> n_subdivisions = {{5, 5, 3}};
+    std::tie( cell_topologies_view, cells, coordinates ) =
+        buildStructuredMesh<DeviceType>( comm, n_subdivisions );
+    DataTransferKit::Mesh<DeviceType> mesh( cell_topologies_view, cells,
+                                            coordinates );
+
+    // Only the first two processors own points so the queries are moved to
+    // the other processors.
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType> points_coord =
+        getPointsCoord3D<DeviceType>( comm );
+    DataTransferKit::PointSearch<DeviceType> pt_search( comm, mesh,
+                                                        points_coord, false,
+                                                        true );
+    DataTransferKit::PointSearch<DeviceType> ref_pt_search( comm, mesh,
+                                                            points_coord );
+    checkSameResults( pt_search, ref_pt_search, success, out );
+
+    // The points that are searched again after an update are also balanced
+    unsigned int const n_points = points_coord.extent( 0 );
+    Kokkos::View<DataTransferKit::Coordinate * [dim], DeviceType>
+        moved_points_coord( "moved_points_coord", n_points );
+    auto moved_points_coord_host =
+        Kokkos::create_mirror_view( moved_points_coord );
+    Kokkos::deep_copy( moved_points_coord_host, points_coord );
+    if ( n_points > 0 )
+        moved_points_coord_host( 1, 0 ) += 1.;
+    Kokkos::deep_copy( moved_points_coord, moved_points_coord_host );
+    pt_search.update( moved_points_coord );
+    DataTransferKit::PointSearch<DeviceType> ref_moved_pt_search(
+        comm, mesh, moved_points_coord );
+    checkSameResults( pt_search, ref_moved_pt_search, success, out );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, balance_clustered_queries,
+                                   DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+    int comm_size;
+    MPI_Comm_size( comm, &comm_size );
+    unsigned int constexpr dim = 3;
+
+    // Every processor owns 10 points clustered in a tiny region, several of
+    // them at the same location, and the first processor also owns a point
+    // far away. The clustered points are close on the space-filling curve but
+    // they must still be spread over all the processors.
+    unsigned int const n_cluster_points = 10;
+    unsigned int const n_points =
+        ( comm_rank == 0 ) ? n_cluster_points + 1 : n_cluster_points;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> points_coord(
+        "points_coord", n_points, dim );
+    auto points_coord_host = Kokkos::create_mirror_view( points_coord );
+    for ( unsigned int i = 0; i < n_cluster_points; ++i )
+    {
+        points_coord_host( i, 0 ) = 1e-4 * ( i % 3 );
+        points_coord_host( i, 1 ) = 1e-4 * ( ( comm_rank + i ) % 2 );
+        points_coord_host( i, 2 ) = 0.;
+    }
+    if ( comm_rank == 0 )
+        for ( unsigned int d = 0; d < dim; ++d )
+            points_coord_host( n_cluster_points, d ) = 1.;
+    Kokkos::deep_copy( points_coord, points_coord_host );
+
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> balanced_points;
+    Kokkos::View<int *, DeviceType> query_ids;
+    Kokkos::View<int *, DeviceType> ranks;
+    std::tie( balanced_points, query_ids, ranks ) =
+        DataTransferKit::internal::balanceQueries(
+            comm, points_coord, Kokkos::View<int *, DeviceType>() );
+
+    // The point at the global position pos along the curve is sent to the
+    // processor pos * comm_size / n_total_points.
+    long long const n_total_points = comm_size * n_cluster_points + 1;
+    auto const first_position = [&]( long long const rank ) {
+        return ( rank * n_total_points + comm_size - 1 ) / comm_size;
+    };
+    TEST_EQUALITY( static_cast<long long>( balanced_points.extent( 0 ) ),
+                   first_position( comm_rank + 1 ) -
+                       first_position( comm_rank ) );
+    TEST_EQUALITY( query_ids.extent( 0 ), balanced_points.extent( 0 ) );
+    TEST_EQUALITY( ranks.extent( 0 ), balanced_points.extent( 0 ) );
+
+    // Every query is received exactly once
+    auto query_ids_host = Kokkos::create_mirror_view( query_ids );
+    Kokkos::deep_copy( query_ids_host, query_ids );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    std::vector<int> n_received( comm_size * ( n_cluster_points + 1 ), 0 );
+    for ( unsigned int i = 0; i < query_ids.extent( 0 ); ++i )
+        ++n_received[ranks_host( i ) * ( n_cluster_points + 1 ) +
+                     query_ids_host( i )];
+    MPI_Allreduce( MPI_IN_PLACE, n_received.data(), n_received.size(),
+                   MPI_INT, MPI_SUM, comm );
+    for ( int r = 0; r < comm_size; ++r )
+        for ( unsigned int i = 0; i < n_cluster_points + 1; ++i )
+            TEST_EQUALITY( n_received[r * ( n_cluster_points + 1 ) + i],
+                           ( ( r == 0 ) || ( i < n_cluster_points ) ) ? 1
+                                                                      : 0 );
+}
+
 // Include the test macros.
 #include "DataTransferKit_ETIHelperMacros.h"
 
@@ -462,6 +966,25 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( PointSearch, two_topo_two_dim, DeviceType )
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT(                                      \
         PointSearch, one_topo_three_dim_no_point_found, DeviceType##NODE )     \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch, two_topo_two_dim,       \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch,                         \
+                                          shared_source_mesh_index,            \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch, update,                 \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch,                         \
+                                          refit_source_mesh_index,             \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch, refit_large_margin,     \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch, kdop_filter,            \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch, unique_results,         \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch, balance_queries,        \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( PointSearch,                         \
+                                          balance_clustered_queries,           \
                                           DeviceType##NODE )
 
 // Demangle the types
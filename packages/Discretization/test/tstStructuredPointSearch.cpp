@@ -0,0 +1,164 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#include <DTK_StructuredPointSearch.hpp>
+
+#include <Teuchos_UnitTestHarness.hpp>
+
+#include <array>
+#include <tuple>
+#include <vector>
+
+// Each processor owns the block [rank, rank+1] x [0, 1] (x [0, 1]). The
+// blocks have two cells along each direction except along z.
+template <typename DeviceType>
+std::array<Kokkos::View<DataTransferKit::Coordinate *, DeviceType>, 3>
+buildEdges( MPI_Comm comm, unsigned int dim )
+{
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+    std::array<std::vector<DataTransferKit::Coordinate>, 3> edges = {
+        {{comm_rank + 0., comm_rank + 0.25, comm_rank + 1.},
+         {0., 0.5, 1.},
+         {0., 1.}}};
+    std::array<Kokkos::View<DataTransferKit::Coordinate *, DeviceType>, 3>
+        edges_view;
+    for ( unsigned int d = 0; d < dim; ++d )
+    {
+        edges_view[d] = Kokkos::View<DataTransferKit::Coordinate *, DeviceType>(
+            "edges", edges[d].size() );
+        auto edges_host = Kokkos::create_mirror_view( edges_view[d] );
+        for ( unsigned int i = 0; i < edges[d].size(); ++i )
+            edges_host( i ) = edges[d][i];
+        Kokkos::deep_copy( edges_view[d], edges_host );
+    }
+
+    return edges_view;
+}
+
+// The `out` and `success` parameters come from the Teuchos unit testing macros
+// expansion.
+template <typename DeviceType>
+void checkResults(
+    DataTransferKit::StructuredPointSearch<DeviceType> const &search,
+    std::vector<std::tuple<unsigned int, int, int,
+                           std::array<DataTransferKit::Coordinate, 3>>> const
+        &ref_results,
+    bool &success, Teuchos::FancyOStream &out )
+{
+    Kokkos::View<int *, DeviceType> ranks;
+    Kokkos::View<int *, DeviceType> cell_indices;
+    Kokkos::View<DataTransferKit::Coordinate * [3], DeviceType>
+        reference_points;
+    Kokkos::View<unsigned int *, DeviceType> query_ids;
+    std::tie( ranks, cell_indices, reference_points, query_ids ) =
+        search.getSearchResults();
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    Kokkos::deep_copy( ranks_host, ranks );
+    auto cell_indices_host = Kokkos::create_mirror_view( cell_indices );
+    Kokkos::deep_copy( cell_indices_host, cell_indices );
+    auto reference_points_host = Kokkos::create_mirror_view( reference_points );
+    Kokkos::deep_copy( reference_points_host, reference_points );
+    auto query_ids_host = Kokkos::create_mirror_view( query_ids );
+    Kokkos::deep_copy( query_ids_host, query_ids );
+
+    // The results are sorted by query id
+    TEST_EQUALITY( query_ids_host.extent( 0 ), ref_results.size() );
+    for ( unsigned int i = 0; i < ref_results.size(); ++i )
+    {
+        TEST_EQUALITY( query_ids_host( i ), std::get<0>( ref_results[i] ) );
+        TEST_EQUALITY( ranks_host( i ), std::get<1>( ref_results[i] ) );
+        TEST_EQUALITY( cell_indices_host( i ), std::get<2>( ref_results[i] ) );
+        for ( unsigned int d = 0; d < 3; ++d )
+            TEST_FLOATING_EQUALITY( reference_points_host( i, d ) + 2.,
+                                    std::get<3>( ref_results[i] )[d] + 2.,
+                                    1e-14 );
+    }
+}
+
+template <typename DeviceType>
+void checkSearch( unsigned int dim, bool &success, Teuchos::FancyOStream &out )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+    int comm_size;
+    MPI_Comm_size( comm, &comm_size );
+
+    auto edges = buildEdges<DeviceType>( comm, dim );
+
+    // The first point is in the block of another processor, the second point
+    // is in the local block, the third point is outside of the grid, and the
+    // last point is on the boundary between two blocks.
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> points_coord(
+        "points_coord", 4, dim );
+    auto points_coord_host = Kokkos::create_mirror_view( points_coord );
+    std::array<std::array<DataTransferKit::Coordinate, 3>, 4> points = {
+        {{{comm_size - 1 - comm_rank + 0.1, 0.75, 0.5}},
+         {{comm_rank + 0.5, 0.25, 0.5}},
+         {{-1., 0.5, 0.5}},
+         {{comm_rank + 1., 0.5, 1.}}}};
+    for ( unsigned int i = 0; i < 4; ++i )
+        for ( unsigned int d = 0; d < dim; ++d )
+            points_coord_host( i, d ) = points[i][d];
+    Kokkos::deep_copy( points_coord, points_coord_host );
+
+    DataTransferKit::StructuredPointSearch<DeviceType> search( comm, edges,
+                                                               points_coord );
+
+    // The cells are numbered lexicographically and the reference cell is
+    // [-1, 1]^dim. A point on the boundary of the grid belongs to the last
+    // cell.
+    double const z = ( dim == 3 ) ? 1. : 0.;
+    bool const last_block = ( comm_rank == comm_size - 1 );
+    std::vector<std::tuple<unsigned int, int, int,
+                           std::array<DataTransferKit::Coordinate, 3>>>
+        ref_results = {
+            std::make_tuple( 0, comm_size - 1 - comm_rank, 2,
+                             std::array<DataTransferKit::Coordinate, 3>{
+                                 {-0.2, 0., 0.}} ),
+            std::make_tuple( 1, comm_rank, 1,
+                             std::array<DataTransferKit::Coordinate, 3>{
+                                 {-1. / 3., 0., 0.}} ),
+            std::make_tuple( 3, last_block ? comm_rank : comm_rank + 1,
+                             last_block ? 3 : 2,
+                             std::array<DataTransferKit::Coordinate, 3>{
+                                 {last_block ? 1. : -1., -1., z}} )};
+    checkResults( search, ref_results, success, out );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( StructuredPointSearch, three_dim,
+                                   DeviceType )
+{
+    checkSearch<DeviceType>( 3, success, out );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( StructuredPointSearch, two_dim, DeviceType )
+{
+    checkSearch<DeviceType>( 2, success, out );
+}
+
+// Include the test macros.
+#include "DataTransferKit_ETIHelperMacros.h"
+
+// Create the test group
+#define UNIT_TEST_GROUP( NODE )                                                \
+    using DeviceType##NODE = typename NODE::device_type;                       \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( StructuredPointSearch, three_dim,    \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( StructuredPointSearch, two_dim,      \
+                                          DeviceType##NODE )
+
+// Demangle the types
+DTK_ETI_MANGLING_TYPEDEFS()
+
+// Instantiate the tests
+DTK_INSTANTIATE_N( UNIT_TEST_GROUP )
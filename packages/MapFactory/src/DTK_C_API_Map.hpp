@@ -22,6 +22,7 @@
 #include <DTK_NearestNeighborOperator.hpp>
 #include <DTK_ParallelTraits.hpp>
 #include <DTK_PointCloudOperator.hpp>
+#include <DTK_SplineOperator.hpp>
 #include <DTK_UserApplication.hpp>
 
 #include <boost/property_tree/json_parser.hpp>
@@ -95,6 +96,16 @@ struct DTK_MapImpl : public DTK_Map
             // not capitalized), the default value (linear polynomials) will be
             // picked up without a warning or an error being raised.
             auto const order = ptree.get<std::string>( "Order", "Linear" );
+            auto const which_solver = ptree.get<std::string>( "Solver", "SVD" );
+            MovingLeastSquaresSolver solver;
+            if ( which_solver == "SVD" )
+                solver = MovingLeastSquaresSolver::SVD;
+            else if ( which_solver == "QR" )
+                solver = MovingLeastSquaresSolver::QR;
+            else
+                throw DataTransferKitException(
+                    "Invalid solver \"" + which_solver +
+                    "\" for creating a moving least squares map" );
             if ( order == "Linear" || order == "1" )
                 _map = std::unique_ptr<MovingLeastSquaresOperator<
                     map_device_type, Wendland<0>,
@@ -102,7 +113,7 @@ struct DTK_MapImpl : public DTK_Map
                     new MovingLeastSquaresOperator<
                         map_device_type, Wendland<0>,
                         MultivariatePolynomialBasis<Linear, 3>>(
-                        comm, source_nodes_copy, target_nodes_copy ) );
+                        comm, source_nodes_copy, target_nodes_copy, solver ) );
             else if ( order == "Quadratic" || order == "2" )
                 _map = std::unique_ptr<MovingLeastSquaresOperator<
                     map_device_type, Wendland<0>,
@@ -110,12 +121,45 @@ struct DTK_MapImpl : public DTK_Map
                     new MovingLeastSquaresOperator<
                         map_device_type, Wendland<0>,
                         MultivariatePolynomialBasis<Quadratic, 3>>(
-                        comm, source_nodes_copy, target_nodes_copy ) );
+                        comm, source_nodes_copy, target_nodes_copy, solver ) );
             else
                 throw DataTransferKitException(
                     "Invalid order \"" + order +
                     "\" for creating a moving least squares map" );
         }
+        else if ( which_map == "Spline" )
+        {
+            // The options of the solve of the coupling matrix are forwarded
+            // to the operator. The convergence tolerance and the maximum
+            // number of iterations are the ones of the default solver.
+            auto parameters = Teuchos::parameterList();
+            parameters->set( "Preconditioner",
+                             ptree.get<std::string>( "Preconditioner",
+                                                     "Schur Complement" ) );
+            parameters->set( "Warm Start",
+                             ptree.get<bool>( "Warm Start", true ) );
+            parameters->set( "Recycling",
+                             ptree.get<bool>( "Recycling", false ) );
+            parameters->set( "Solver",
+                             ptree.get<std::string>( "Solver", "Iterative" ) );
+            if ( auto direct_solver =
+                     ptree.get_optional<std::string>( "Direct Solver" ) )
+                parameters->set( "Direct Solver", *direct_solver );
+            auto &gmres_list = parameters->sublist( "Stratimikos" )
+                                   .sublist( "Linear Solver Types" )
+                                   .sublist( "Belos" )
+                                   .sublist( "Solver Types" )
+                                   .sublist( "Pseudo Block GMRES" );
+            if ( auto tolerance =
+                     ptree.get_optional<double>( "Convergence Tolerance" ) )
+                gmres_list.set( "Convergence Tolerance", *tolerance );
+            if ( auto max_iterations =
+                     ptree.get_optional<int>( "Maximum Iterations" ) )
+                gmres_list.set( "Maximum Iterations", *max_iterations );
+            _map = std::unique_ptr<SplineOperator<map_device_type>>(
+                new SplineOperator<map_device_type>(
+                    comm, source_nodes_copy, target_nodes_copy, parameters ) );
+        }
         else
             throw DataTransferKitException( "Invalid map type \"" + which_map +
                                             "\"" );
@@ -226,6 +226,14 @@ void test( bool &success, Teuchos::FancyOStream &out )
                                                       // double quoted
               R"({ "Map Type": "MLS", "Order": "Quadratic" })",
               R"({ "Map Type": "MLS", "Order": "2" })",
+              R"({ "Map Type": "MLS", "Solver": "SVD" })",
+              R"({ "Map Type": "MLS", "Order": "2", "Solver": "QR" })",
+              R"({ "Map Type": "Spline" })",
+              R"({ "Map Type": "Spline", "Preconditioner": "None" })",
+              R"({ "Map Type": "Spline", "Convergence Tolerance": 1e-8,
+                   "Maximum Iterations": 100 })",
+              R"({ "Map Type": "Spline", "Warm Start": false })",
+              R"({ "Map Type": "Spline", "Recycling": true })",
           } )
     {
         auto map_handle =
@@ -259,6 +267,9 @@ void test( bool &success, Teuchos::FancyOStream &out )
             R"({ "Map Type": "Is Not Defined Anywhere" })", // invalid value
             R"({ "Map Type": "MLS", "Order": 3 })", // order 3 not available
             R"({ "Map Type": "MLS", "Order": "Invalid" })",
+            R"({ "Map Type": "MLS", "Solver": "LU" })", // invalid solver
+            R"({ "Map Type": "Spline", "Preconditioner": "ILU" })",
+            R"({ "Map Type": "Spline", "Solver": "Cholesky" })",
         } )
     {
         TEST_THROW( DTK_createMap( SpaceSelector<MapSpace>::value(), comm,
@@ -270,6 +281,7 @@ void test( bool &success, Teuchos::FancyOStream &out )
     for ( std::string const options : {
               R"({ "Map Type": "Nearest Neighbor" })",
               R"({ "Map Type": "Moving Least Squares" })",
+              R"({ "Map Type": "Moving Least Squares", "Solver": "QR" })",
           } )
     {
         auto map_handle =
@@ -0,0 +1,182 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DTK_DETAILS_COMMUNICATION_PLAN_HPP
+#define DTK_DETAILS_COMMUNICATION_PLAN_HPP
+
+#include <ArborX.hpp>
+#include <DTK_DBC.hpp>
+
+#include <mpi.h>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+
+/**
+ * This class stores the communication pattern needed to fetch values owned by
+ * other processors. The pattern is set up once from a list of (rank, index)
+ * requests. Then, each call to fetch() only sends the requested values,
+ * instead of negotiating the pattern, the indices, and the ranks again.
+ */
+template <typename DeviceType>
+class CommunicationPlan
+{
+  public:
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    CommunicationPlan( MPI_Comm comm )
+        : _comm( comm )
+        , _distributor( comm )
+        , _export_indices( "export_indices", 0 )
+        , _import_indices( "import_indices", 0 )
+    {
+    }
+
+    /**
+     * Set up the communication pattern. The i-th value returned by fetch() is
+     * the value with local index \p indices(i) on the processor \p ranks(i).
+     */
+    void createFromRequests( Kokkos::View<int const *, DeviceType> ranks,
+                             Kokkos::View<int const *, DeviceType> indices )
+    {
+        DTK_REQUIRE( ranks.extent( 0 ) == indices.extent( 0 ) );
+
+        int const n_requests = ranks.extent( 0 );
+
+        // Send the requests to the processors owning the values. We send the
+        // position of the request so that the values can be put in the right
+        // place once they come back.
+        Kokkos::View<int *, DeviceType> request_ranks =
+            Kokkos::create_mirror( DeviceType(), ranks );
+        Kokkos::deep_copy( request_ranks, ranks );
+        ArborX::Details::Distributor<DeviceType> request_distributor( _comm );
+        int const n_owned = request_distributor.createFromSends(
+            ExecutionSpace{}, request_ranks );
+
+        Kokkos::View<int *, DeviceType> export_positions( "positions",
+                                                          n_requests );
+        ArborX::iota( ExecutionSpace{}, export_positions );
+        Kokkos::View<int *, DeviceType> import_positions( "positions",
+                                                          n_owned );
+        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+            ExecutionSpace{}, request_distributor, export_positions,
+            import_positions );
+
+        Kokkos::View<int *, DeviceType> request_indices =
+            Kokkos::create_mirror( DeviceType(), indices );
+        Kokkos::deep_copy( request_indices, indices );
+        Kokkos::realloc( _export_indices, n_owned );
+        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+            ExecutionSpace{}, request_distributor, request_indices,
+            _export_indices );
+
+        int comm_rank;
+        MPI_Comm_rank( _comm, &comm_rank );
+        Kokkos::View<int *, DeviceType> export_ranks( "ranks", n_requests );
+        Kokkos::deep_copy( export_ranks, comm_rank );
+        Kokkos::View<int *, DeviceType> import_ranks( "ranks", n_owned );
+        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+            ExecutionSpace{}, request_distributor, export_ranks,
+            import_ranks );
+
+        // Build the distributor used to send the values back to the processors
+        // that requested them. The positions of the requests are sent back
+        // once so that the order in which the values are received is known.
+        int const n_imports =
+            _distributor.createFromSends( ExecutionSpace{}, import_ranks );
+        Kokkos::realloc( _import_indices, n_imports );
+        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+            ExecutionSpace{}, _distributor, import_positions, _import_indices );
+
+        DTK_ENSURE( n_imports == n_requests );
+    }
+
+    /**
+     * Return the values requested in createFromRequests(). \p values are the
+     * values owned by the current processor.
+     */
+    template <typename View>
+    typename View::non_const_type fetch( View values ) const
+    {
+        static_assert( View::rank == 1 || View::rank == 2,
+                       "fetch() requires rank-1 or rank-2 view arguments" );
+
+        int const n_exports = _export_indices.extent( 0 );
+        int const n_imports = _import_indices.extent( 0 );
+        int const n_components = values.extent( 1 );
+
+        auto export_values =
+            View::rank == 1
+                ? typename View::non_const_type( values.label(), n_exports )
+                : typename View::non_const_type( values.label(), n_exports,
+                                                 n_components );
+        auto const export_indices = _export_indices;
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "pack_values" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_exports ),
+            KOKKOS_LAMBDA( int i ) {
+                // TODO Using Kokkos::View::access() is a workaround.
+                // We should write specializations for rank-1 and rank-2
+                // objects.
+                for ( int j = 0; j < n_components; ++j )
+                    export_values.access( i, j ) =
+                        values.access( export_indices( i ), j );
+            } );
+        Kokkos::fence();
+
+        auto import_values =
+            View::rank == 1
+                ? typename View::non_const_type( values.label(), n_imports )
+                : typename View::non_const_type( values.label(), n_imports,
+                                                 n_components );
+        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
+            ExecutionSpace{}, _distributor, export_values, import_values );
+
+        auto values_out =
+            View::rank == 1
+                ? typename View::non_const_type( values.label(), n_imports )
+                : typename View::non_const_type( values.label(), n_imports,
+                                                 n_components );
+        auto const import_indices = _import_indices;
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "unpack_values" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
+            KOKKOS_LAMBDA( int i ) {
+                for ( int j = 0; j < n_components; ++j )
+                    values_out.access( import_indices( i ), j ) =
+                        import_values.access( i, j );
+            } );
+        Kokkos::fence();
+
+        DTK_ENSURE( ( values_out.extent( 0 ) == _import_indices.extent( 0 ) ) &&
+                    ( values_out.extent( 1 ) == values.extent( 1 ) ) );
+
+        return values_out;
+    }
+
+  private:
+    MPI_Comm _comm;
+    // Distributor used to send the values from the processors owning them to
+    // the processors that requested them.
+    ArborX::Details::Distributor<DeviceType> _distributor;
+    // Local indices of the values to send, in the order expected by
+    // _distributor.
+    Kokkos::View<int *, DeviceType> _export_indices;
+    // Position of the received values in the output of fetch().
+    Kokkos::View<int *, DeviceType> _import_indices;
+};
+
+} // namespace Details
+} // namespace DataTransferKit
+
+#endif
@@ -14,8 +14,12 @@
 
 #include <ArborX.hpp>
 #include <DTK_CompactlySupportedRadialBasisFunctions.hpp>
+#include <DTK_DetailsPoints.hpp>
+#include <DTK_DetailsQRImpl.hpp>
 #include <DTK_DetailsSVDImpl.hpp>
 
+#include <tuple>
+
 namespace DataTransferKit
 {
 namespace Details
@@ -37,23 +41,102 @@ struct MovingLeastSquaresOperatorImpl
             DTK_MARK_REGION( "setup_queries" ),
             Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
             KOKKOS_LAMBDA( int i ) {
-                queries( i ) = nearest(
-                    ArborX::Point{{target_points( i, 0 ), target_points( i, 1 ),
-                                   target_points( i, 2 )}},
-                    n_neighbors );
+                queries( i ) =
+                    nearest( makePoint( target_points, i ), n_neighbors );
             } );
         Kokkos::fence();
         return queries;
     }
 
+    // Remove the duplicates from the (rank, index) pairs found by the search.
+    // Return the ranks and the indices of the unique source points, i.e., the
+    // halo, and for each pair the position of the source point in the halo.
+    static std::tuple<Kokkos::View<int *, DeviceType>,
+                      Kokkos::View<int *, DeviceType>,
+                      Kokkos::View<int *, DeviceType>>
+    buildHalo( Kokkos::View<int const *, DeviceType> ranks,
+               Kokkos::View<int const *, DeviceType> indices )
+    {
+        DTK_REQUIRE( ranks.extent( 0 ) == indices.extent( 0 ) );
+
+        int const n_neighbors = ranks.extent( 0 );
+        Kokkos::View<int *, DeviceType> halo_ranks( "halo_ranks", 0 );
+        Kokkos::View<int *, DeviceType> halo_indices( "halo_indices", 0 );
+        Kokkos::View<int *, DeviceType> neighbor_indices( "neighbor_indices",
+                                                          n_neighbors );
+        if ( n_neighbors == 0 )
+            return std::make_tuple( halo_ranks, halo_indices,
+                                    neighbor_indices );
+
+        ExecutionSpace space;
+        int max_index = 0;
+        Kokkos::parallel_reduce(
+            DTK_MARK_REGION( "compute_max_index" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_neighbors ),
+            KOKKOS_LAMBDA( int const i, int &local_max ) {
+                if ( indices( i ) > local_max )
+                    local_max = indices( i );
+            },
+            Kokkos::Max<int>( max_index ) );
+
+        // Sort the pairs using a unique key per (rank, index) pair. The keys
+        // are sorted in place and the duplicates are then next to each other.
+        long long const n_indices = max_index + 1;
+        Kokkos::View<long long *, DeviceType> keys( "keys", n_neighbors );
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "compute_keys" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_neighbors ),
+            KOKKOS_LAMBDA( int const i ) {
+                keys( i ) = ranks( i ) * n_indices + indices( i );
+            } );
+        Kokkos::fence();
+        auto const permute = ArborX::Details::sortObjects( space, keys );
+
+        // Number the unique pairs
+        Kokkos::View<int *, DeviceType> halo_offset( "halo_offset",
+                                                     n_neighbors + 1 );
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "compute_mask" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_neighbors ),
+            KOKKOS_LAMBDA( int const i ) {
+                if ( ( i == 0 ) || ( keys( i - 1 ) != keys( i ) ) )
+                    halo_offset( i ) = 1;
+                else
+                    halo_offset( i ) = 0;
+            } );
+        Kokkos::fence();
+        ArborX::exclusivePrefixSum( space, halo_offset );
+        int const n_halo = ArborX::lastElement( halo_offset );
+
+        Kokkos::realloc( halo_ranks, n_halo );
+        Kokkos::realloc( halo_indices, n_halo );
+        Kokkos::parallel_for(
+            DTK_MARK_REGION( "fill_halo" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_neighbors ),
+            KOKKOS_LAMBDA( int const i ) {
+                int const halo_index = halo_offset( i + 1 ) - 1;
+                int const j = permute( i );
+                neighbor_indices( j ) = halo_index;
+                if ( halo_offset( i + 1 ) != halo_offset( i ) )
+                {
+                    halo_ranks( halo_index ) = ranks( j );
+                    halo_indices( halo_index ) = indices( j );
+                }
+            } );
+        Kokkos::fence();
+
+        return std::make_tuple( halo_ranks, halo_indices, neighbor_indices );
+    }
+
     static Kokkos::View<double *, DeviceType> computeTargetValues(
         Kokkos::View<int const *, DeviceType> offset,
+        Kokkos::View<int const *, DeviceType> neighbor_indices,
         Kokkos::View<double const *, DeviceType> polynomial_coeffs,
-        Kokkos::View<double const *, DeviceType> source_values )
+        Kokkos::View<double const *, DeviceType> halo_values )
     {
         auto const n_target_points = offset.extent_int( 0 ) - 1;
         Kokkos::View<double *, DeviceType> target_values(
-            std::string( "target_" ) + source_values.label(), n_target_points );
+            std::string( "target_" ) + halo_values.label(), n_target_points );
 
         Kokkos::parallel_for(
             DTK_MARK_REGION( "compute_values" ),
@@ -62,7 +145,8 @@ struct MovingLeastSquaresOperatorImpl
                 target_values( i ) = 0.;
                 for ( int j = offset( i ); j < offset( i + 1 ); ++j )
                     target_values( i ) +=
-                        polynomial_coeffs( j ) * source_values( j );
+                        polynomial_coeffs( j ) *
+                        halo_values( neighbor_indices( j ) );
             } );
         Kokkos::fence();
 
@@ -70,15 +154,16 @@ struct MovingLeastSquaresOperatorImpl
     }
 
     static Kokkos::View<Coordinate **, DeviceType> transformSourceCoordinates(
-        Kokkos::View<Coordinate const **, DeviceType> source_points,
+        Kokkos::View<Coordinate const **, DeviceType> halo_points,
+        Kokkos::View<int const *, DeviceType> neighbor_indices,
         Kokkos::View<int const *, DeviceType> offset,
         Kokkos::View<Coordinate const **, DeviceType> target_points )
     {
-        auto const n_source_points = source_points.extent( 0 );
+        auto const n_source_points = neighbor_indices.extent( 0 );
         auto const n_target_points = target_points.extent( 0 );
 
-        int const spatial_dim = 3;
-        DTK_REQUIRE( source_points.extent_int( 1 ) == spatial_dim );
+        int const spatial_dim = target_points.extent_int( 1 );
+        DTK_REQUIRE( halo_points.extent_int( 1 ) == spatial_dim );
         DTK_REQUIRE( offset.extent( 0 ) == n_target_points + 1 );
 
         // Change the coordinates of the source points to relative position to
@@ -92,7 +177,8 @@ struct MovingLeastSquaresOperatorImpl
                 for ( int j = offset( i ); j < offset( i + 1 ); j++ )
                     for ( int k = 0; k < spatial_dim; k++ )
                         new_source_points( j, k ) =
-                            source_points( j, k ) - target_points( i, k );
+                            halo_points( neighbor_indices( j ), k ) -
+                            target_points( i, k );
             } );
 
         return new_source_points;
@@ -119,10 +205,7 @@ struct MovingLeastSquaresOperatorImpl
                 for ( int j = offset( i ); j < offset( i + 1 ); ++j )
                 {
                     double new_distance = ArborX::Details::distance(
-                        ArborX::Point{{source_points( j, 0 ),
-                                       source_points( j, 1 ),
-                                       source_points( j, 2 )}},
-                        {0., 0., 0.} );
+                        makePoint( source_points, j ), {0., 0., 0.} );
 
                     if ( new_distance > distance )
                         distance = new_distance;
@@ -148,8 +231,6 @@ struct MovingLeastSquaresOperatorImpl
     {
         auto const n_source_points = source_points.extent( 0 );
 
-        DTK_REQUIRE( source_points.extent_int( 1 ) == 3 );
-
         // The argument of rbf is a distance because we have changed the
         // coordinate system such the target point is the origin of the new
         // coordinate system.
@@ -160,35 +241,12 @@ struct MovingLeastSquaresOperatorImpl
             KOKKOS_LAMBDA( int i ) {
                 RadialBasisFunction<RBF> rbf( radius( i ) );
                 phi( i ) = rbf( ArborX::Details::distance(
-                    ArborX::Point{{source_points( i, 0 ), source_points( i, 1 ),
-                                   source_points( i, 2 )}},
-                    {0., 0., 0.} ) );
+                    makePoint( source_points, i ), {0., 0., 0.} ) );
             } );
         Kokkos::fence();
         return phi;
     }
 
-    template <typename PolynomialBasis>
-    static Kokkos::View<double *, DeviceType>
-    computeVandermonde( Kokkos::View<Coordinate const **, DeviceType> points,
-                        PolynomialBasis const &polynomial_basis )
-    {
-        auto const n_points = points.extent( 0 );
-        auto constexpr size_polynomial_basis = PolynomialBasis::size;
-        Kokkos::View<double *, DeviceType> p(
-            "vandermonde", n_points * size_polynomial_basis );
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "compute_polynomial_basis" ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
-            KOKKOS_LAMBDA( int i ) {
-                auto const tmp = polynomial_basis( ArborX::Point{
-                    {points( i, 0 ), points( i, 1 ), points( i, 2 )}} );
-                for ( int j = 0; j < size_polynomial_basis; ++j )
-                    p( i * size_polynomial_basis + j ) = tmp[j];
-            } );
-        return p;
-    }
-
     template <typename PolynomialBasis>
     static Kokkos::View<double **, DeviceType>
     computeVandermonde2( Kokkos::View<Coordinate const **, DeviceType> points,
@@ -202,136 +260,217 @@ struct MovingLeastSquaresOperatorImpl
             DTK_MARK_REGION( "compute_polynomial_basis" ),
             Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
             KOKKOS_LAMBDA( int i ) {
-                auto const tmp = polynomial_basis( ArborX::Point{
-                    {points( i, 0 ), points( i, 1 ), points( i, 2 )}} );
+                auto const tmp = polynomial_basis( makePoint( points, i ) );
                 for ( int j = 0; j < size_polynomial_basis; ++j )
                     p( i, j ) = tmp[j];
             } );
         return p;
     }
 
-    static Kokkos::View<double *, DeviceType>
-    computeMoments( Kokkos::View<int const *, DeviceType> offset,
-                    Kokkos::View<double const *, DeviceType> p,
-                    Kokkos::View<double const *, DeviceType> phi )
-    {
-        auto const n_target_points = offset.extent_int( 0 ) - 1;
-        auto const n_source_points = phi.extent_int( 0 );
-        DTK_REQUIRE( n_source_points == ArborX::lastElement( offset ) );
-        if ( n_source_points == 0 )
-            return Kokkos::View<double *, DeviceType>( "moments", 0 );
-        auto const size_polynomial_basis = p.extent_int( 0 ) / n_source_points;
-        auto const size_polynomial_basis_squared =
-            size_polynomial_basis * size_polynomial_basis;
-        Kokkos::View<double *, DeviceType> a(
-            "moments", n_target_points * size_polynomial_basis_squared );
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "compute_moments" ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, n_target_points ),
-            KOKKOS_LAMBDA( int i ) {
-                auto p_i = Kokkos::subview(
-                    p, Kokkos::make_pair( offset( i ) * size_polynomial_basis,
-                                          offset( i + 1 ) *
-                                              size_polynomial_basis ) );
-                auto phi_i = Kokkos::subview(
-                    phi, Kokkos::make_pair( offset( i ), offset( i + 1 ) ) );
-                auto a_i = Kokkos::subview(
-                    a, Kokkos::make_pair( i * size_polynomial_basis_squared,
-                                          ( i + 1 ) *
-                                              size_polynomial_basis_squared ) );
-                for ( int j = 0; j < size_polynomial_basis; ++j )
-                    for ( int k = 0; k < size_polynomial_basis; ++k )
-                    {
-                        double tmp = 0.;
-                        for ( int l = 0; l < offset( i + 1 ) - offset( i );
-                              ++l )
-                            // Compute value (j,k)
-                            tmp += p_i( l * size_polynomial_basis + j ) *
-                                   phi_i( l ) *
-                                   p_i( l * size_polynomial_basis + k );
-                        a_i( j * size_polynomial_basis + k ) = tmp;
-                    }
-            } );
-        Kokkos::fence();
-
-        return a;
-    }
-
-    // Matrix pseudo-inversion using SVD
-    // Takes in a 1D array of matrices of size NxN, and returns a 1D array of
-    // matrices of the same size containing corresponding pseudo-inverses
-    static std::tuple<Kokkos::View<double *, DeviceType>, size_t>
-    invertMoments( Kokkos::View<double const *, DeviceType> a,
-                   const int size_polynomial_basis )
-    {
-        Kokkos::View<double *, DeviceType> inv_a( "inv_a", a.extent( 0 ) );
-
-        auto num_matrices =
-            a.extent( 0 ) / ( size_polynomial_basis * size_polynomial_basis );
-
-        // We request auxiliary space for matrices E, U, and V (thus, 3) that
-        // we need inside SVD. Single level parallelism does not provide access
-        // to scratch space (or, at the least, I don't know how to access it).
-        // So we preallocate it here, and pass to the functor. We use 2D array
-        // as we would like to use 2D matrices inside SVD, and there is no way
-        // to reshape.
-        Kokkos::View<double **, DeviceType> aux( "aux", size_polynomial_basis,
-                                                 3 * num_matrices *
-                                                     size_polynomial_basis );
-
-        SVDFunctor<DeviceType> svdFunctor( size_polynomial_basis, a, inv_a,
-                                           aux );
-        size_t num_underdetermined = 0;
-        Kokkos::parallel_reduce(
-            DTK_MARK_REGION( "compute_svd_inverse" ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, num_matrices ), svdFunctor,
-            num_underdetermined );
-
-        return std::make_tuple( inv_a, num_underdetermined );
-    }
-
-    static Kokkos::View<double *, DeviceType> computePolynomialCoefficients(
+    // Compute the coefficients of the moving least squares for all the target
+    // points in a single kernel. Each team handles one target point: the
+    // Vandermonde matrix P, the weights phi, and the moment matrix A = P^T phi
+    // P of its neighbors only live in the scratch memory of the team and only
+    // the coefficients are written to global memory. We need the fifth
+    // argument for the template deduction of the radial basis function (see
+    // computeWeights). If use_qr is true, A is not formed and the Householder
+    // QR factorization of sqrt(phi) P is used instead of the SVD of A.
+    template <typename RBF, typename PolynomialBasis>
+    static Kokkos::View<double *, DeviceType> computeCoefficients(
+        Kokkos::View<Coordinate const **, DeviceType> halo_points,
+        Kokkos::View<int const *, DeviceType> neighbor_indices,
         Kokkos::View<int const *, DeviceType> offset,
-        Kokkos::View<double const *, DeviceType> inv_a,
-        Kokkos::View<double const *, DeviceType> p,
-        Kokkos::View<double const *, DeviceType> phi,
-        const int size_polynomial_basis )
+        Kokkos::View<Coordinate const **, DeviceType> target_points,
+        RBF const &, PolynomialBasis const &polynomial_basis,
+        bool const use_qr = false )
     {
-        auto const size_polynomial_basis_squared =
-            size_polynomial_basis * size_polynomial_basis;
-
-        auto num_matrices = inv_a.extent( 0 ) / size_polynomial_basis_squared;
-
-        Kokkos::View<double *, DeviceType> coeffs( "polynomial_coeffs",
-                                                   phi.extent( 0 ) );
-
+        auto const n_target_points = target_points.extent_int( 0 );
+        int const spatial_dim = target_points.extent_int( 1 );
+        DTK_REQUIRE( halo_points.extent_int( 1 ) == spatial_dim );
+        DTK_REQUIRE( offset.extent_int( 0 ) == n_target_points + 1 );
+
+        Kokkos::View<double *, DeviceType> coeffs(
+            "polynomial_coeffs", neighbor_indices.extent( 0 ) );
+        if ( n_target_points == 0 )
+            return coeffs;
+
+        // The scratch memory is sized for the largest number of neighbors
+        int max_n_neighbors = 0;
+        Kokkos::parallel_reduce(
+            DTK_MARK_REGION( "compute_max_n_neighbors" ),
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_target_points ),
+            KOKKOS_LAMBDA( int const i, int &local_max ) {
+                int const n_neighbors = offset( i + 1 ) - offset( i );
+                if ( n_neighbors > local_max )
+                    local_max = n_neighbors;
+            },
+            Kokkos::Max<int>( max_n_neighbors ) );
+
+        int constexpr size_polynomial_basis = PolynomialBasis::size;
+        using ScratchSpace = typename ExecutionSpace::scratch_memory_space;
+        using ScratchVector =
+            Kokkos::View<double *, ScratchSpace, Kokkos::MemoryUnmanaged>;
+        using ScratchMatrix =
+            Kokkos::View<double **, ScratchSpace, Kokkos::MemoryUnmanaged>;
+        // P and phi, plus the scaling factors of the Householder reflections
+        // with QR or A and the first row of its pseudo-inverse with SVD
+        int scratch_size = ScratchMatrix::shmem_size( max_n_neighbors,
+                                                      size_polynomial_basis ) +
+                           ScratchVector::shmem_size( max_n_neighbors );
+        if ( use_qr )
+            scratch_size += ScratchVector::shmem_size( size_polynomial_basis );
+        else
+            scratch_size += ScratchMatrix::shmem_size( size_polynomial_basis,
+                                                       size_polynomial_basis ) +
+                            ScratchVector::shmem_size( size_polynomial_basis );
+
+        using TeamPolicy = Kokkos::TeamPolicy<ExecutionSpace>;
         Kokkos::parallel_for(
             DTK_MARK_REGION( "compute_polynomial_coeffs" ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, num_matrices ),
-            KOKKOS_LAMBDA( const int i ) {
-                auto p_i = Kokkos::subview(
-                    p, Kokkos::make_pair( offset( i ) * size_polynomial_basis,
-                                          offset( i + 1 ) *
-                                              size_polynomial_basis ) );
-                auto phi_i = Kokkos::subview(
-                    phi, Kokkos::make_pair( offset( i ), offset( i + 1 ) ) );
-                auto inv_a_i = Kokkos::subview(
-                    inv_a, Kokkos::make_pair(
-                               i * size_polynomial_basis_squared,
-                               ( i + 1 ) * size_polynomial_basis_squared ) );
-                auto coeffs_i = Kokkos::subview(
-                    coeffs, Kokkos::make_pair( offset( i ), offset( i + 1 ) ) );
-
-                // coeffs = [1 0 ... 0] * a_inv * p^T * phi
-                for ( int k = 0; k < offset( i + 1 ) - offset( i ); k++ )
+            TeamPolicy( n_target_points, Kokkos::AUTO )
+                .set_scratch_size( 0, Kokkos::PerTeam( scratch_size ) ),
+            KOKKOS_LAMBDA( typename TeamPolicy::member_type const &team ) {
+                int const i = team.league_rank();
+                int const begin = offset( i );
+                int const n_neighbors = offset( i + 1 ) - begin;
+                ScratchMatrix p( team.team_scratch( 0 ), n_neighbors,
+                                 size_polynomial_basis );
+                ScratchVector phi( team.team_scratch( 0 ), n_neighbors );
+
+                // Build P using the coordinates of the source points relative
+                // to the target point. The distances to the target point are
+                // stored in phi until the radius is known.
+                Kokkos::parallel_for(
+                    Kokkos::TeamThreadRange( team, n_neighbors ),
+                    [&]( int const j ) {
+                        Kokkos::Array<double, 3> x = {{0., 0., 0.}};
+                        for ( int k = 0; k < spatial_dim; ++k )
+                            x[k] = halo_points( neighbor_indices( begin + j ),
+                                                k ) -
+                                   target_points( i, k );
+                        auto const basis = polynomial_basis( x );
+                        for ( int k = 0; k < size_polynomial_basis; ++k )
+                            p( j, k ) = basis[k];
+                        phi( j ) = std::sqrt( x[0] * x[0] + x[1] * x[1] +
+                                              x[2] * x[2] );
+                    } );
+                team.team_barrier();
+
+                // The radius is the largest distance. It has a minimal
+                // positive value because we divide by the radius in the
+                // radial basis function and it is increased so that no point
+                // is exactly on the boundary of the compact domain (see
+                // computeRadius).
+                double distance = 0.;
+                Kokkos::parallel_reduce(
+                    Kokkos::TeamThreadRange( team, n_neighbors ),
+                    [&]( int const j, double &local_max ) {
+                        if ( phi( j ) > local_max )
+                            local_max = phi( j );
+                    },
+                    Kokkos::Max<double>( distance ) );
+                if ( distance < 10. * DBL_EPSILON )
+                    distance = 10. * DBL_EPSILON;
+                RadialBasisFunction<RBF> rbf( 1.1 * distance );
+                Kokkos::parallel_for(
+                    Kokkos::TeamThreadRange( team, n_neighbors ),
+                    [&]( int const j ) { phi( j ) = rbf( phi( j ) ); } );
+                team.team_barrier();
+
+                if ( use_qr )
                 {
-                    coeffs_i( k ) = 0.;
-                    for ( int j = 0; j < size_polynomial_basis; j++ )
-                        coeffs_i( k ) +=
-                            inv_a_i( 0 * size_polynomial_basis + j ) *
-                            p_i( k * size_polynomial_basis + j ) * phi_i( k );
+                    // Factorize B = sqrt(phi) P instead of forming
+                    // A = B^T B, which squares the condition number. Then
+                    // coeffs = [1 0 ... 0] * A^+ * P^T * phi is the first row
+                    // of the pseudo-inverse of B scaled by sqrt(phi). R is
+                    // only pseudo-inverted when B is rank deficient.
+                    ScratchVector tau( team.team_scratch( 0 ),
+                                       size_polynomial_basis );
+                    Kokkos::parallel_for(
+                        Kokkos::TeamThreadRange(
+                            team, n_neighbors * size_polynomial_basis ),
+                        [&]( int const jk ) {
+                            int const j = jk / size_polynomial_basis;
+                            int const k = jk % size_polynomial_basis;
+                            p( j, k ) *= std::sqrt( phi( j ) );
+                        } );
+                    team.team_barrier();
+
+                    Kokkos::single( Kokkos::PerTeam( team ), [&]() {
+                        auto row = Kokkos::subview(
+                            coeffs,
+                            Kokkos::make_pair( begin, begin + n_neighbors ) );
+                        int const rank_deficiency =
+                            householderQR<size_polynomial_basis>( p, tau,
+                                                                  n_neighbors );
+                        firstRowOfPseudoInverse<size_polynomial_basis>(
+                            p, tau, n_neighbors, rank_deficiency, row );
+                    } );
+                    team.team_barrier();
+
+                    Kokkos::parallel_for(
+                        Kokkos::TeamThreadRange( team, n_neighbors ),
+                        [&]( int const j ) {
+                            coeffs( begin + j ) *= std::sqrt( phi( j ) );
+                        } );
+                }
+                else
+                {
+                    ScratchMatrix a( team.team_scratch( 0 ),
+                                     size_polynomial_basis,
+                                     size_polynomial_basis );
+                    ScratchVector inv_a( team.team_scratch( 0 ),
+                                         size_polynomial_basis );
+
+                    // Build A
+                    Kokkos::parallel_for(
+                        Kokkos::TeamThreadRange(
+                            team, size_polynomial_basis *
+                                      size_polynomial_basis ),
+                        [&]( int const jk ) {
+                            int const j = jk / size_polynomial_basis;
+                            int const k = jk % size_polynomial_basis;
+                            double tmp = 0.;
+                            for ( int l = 0; l < n_neighbors; ++l )
+                                tmp += p( l, j ) * phi( l ) * p( l, k );
+                            a( j, k ) = tmp;
+                        } );
+                    team.team_barrier();
+
+                    // NOTE: This assumes that the polynomial basis evaluated
+                    // at {0,0,0} is going to be [1, 0, 0, ..., 0]^T so only
+                    // the first row of the pseudo-inverse of A is needed.
+                    // The SVD is done in registers since the size of the
+                    // polynomial basis is known at compile time.
+                    Kokkos::single( Kokkos::PerTeam( team ), [&]() {
+                        using Matrix =
+                            Kokkos::Array<Kokkos::Array<double,
+                                                        size_polynomial_basis>,
+                                          size_polynomial_basis>;
+                        Matrix a_i;
+                        for ( int j = 0; j < size_polynomial_basis; ++j )
+                            for ( int k = 0; k < size_polynomial_basis; ++k )
+                                a_i[j][k] = a( j, k );
+                        Matrix inv_a_i;
+                        pseudoInverse<size_polynomial_basis>( a_i, inv_a_i );
+                        for ( int j = 0; j < size_polynomial_basis; ++j )
+                            inv_a( j ) = inv_a_i[0][j];
+                    } );
+                    team.team_barrier();
+
+                    // coeffs = [1 0 ... 0] * a_inv * p^T * phi
+                    Kokkos::parallel_for(
+                        Kokkos::TeamThreadRange( team, n_neighbors ),
+                        [&]( int const j ) {
+                            double tmp = 0.;
+                            for ( int k = 0; k < size_polynomial_basis; ++k )
+                                tmp += inv_a( k ) * p( j, k );
+                            coeffs( begin + j ) = tmp * phi( j );
+                        } );
                 }
             } );
+        Kokkos::fence();
+
         return coeffs;
     }
 };
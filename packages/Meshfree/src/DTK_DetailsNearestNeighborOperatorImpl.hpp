@@ -14,6 +14,8 @@
 
 #include <ArborX.hpp>
 #include <DTK_DBC.hpp>
+#include <DTK_DetailsCommunicationPlan.hpp>
+#include <DTK_DetailsPoints.hpp>
 
 namespace DataTransferKit
 {
@@ -36,119 +38,15 @@ struct NearestNeighborOperatorImpl
             DTK_MARK_REGION( "setup_queries" ),
             Kokkos::RangePolicy<ExecutionSpace>( 0, n_target_points ),
             KOKKOS_LAMBDA( int i ) {
-                nearest_queries( i ) = nearest(
-                    ArborX::Point{{target_points( i, 0 ), target_points( i, 1 ),
-                                   target_points( i, 2 )}} );
+                nearest_queries( i ) =
+                    nearest( makePoint( target_points, i ) );
             } );
         Kokkos::fence();
         return nearest_queries;
     }
 
-    template <typename View>
-    static void
-    pullSourceValues( MPI_Comm comm, View source_values,
-                      Kokkos::View<int *, DeviceType> &buffer_indices,
-                      Kokkos::View<int *, DeviceType> &buffer_ranks,
-                      typename View::non_const_type &buffer_values )
-    {
-        static_assert(
-            View::rank == 1 || View::rank == 2,
-            "pullSourceValues() requires rank-1 or rank-2 view arguments" );
-        int const n_exports = buffer_indices.extent( 0 );
-        ArborX::Details::Distributor<DeviceType> distributor( comm );
-        int const n_imports =
-            distributor.createFromSends( ExecutionSpace{}, buffer_ranks );
-
-        Kokkos::View<int *, DeviceType> export_target_indices( "target_indices",
-                                                               n_exports );
-        ArborX::iota( ExecutionSpace{}, export_target_indices );
-        Kokkos::View<int *, DeviceType> import_target_indices( "target_indices",
-                                                               n_imports );
-        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
-            ExecutionSpace{}, distributor, export_target_indices,
-            import_target_indices );
-
-        Kokkos::View<int *, DeviceType> export_source_indices = buffer_indices;
-        Kokkos::View<int *, DeviceType> import_source_indices( "source_indices",
-                                                               n_imports );
-        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
-            ExecutionSpace{}, distributor, export_source_indices,
-            import_source_indices );
-
-        Kokkos::View<int *, DeviceType> export_ranks( "ranks", n_exports );
-        Kokkos::View<int *, DeviceType> import_ranks( "ranks", n_imports );
-        int comm_rank;
-        MPI_Comm_rank( comm, &comm_rank );
-        Kokkos::deep_copy( export_ranks, comm_rank );
-        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
-            ExecutionSpace{}, distributor, export_ranks, import_ranks );
-
-        buffer_indices = import_target_indices;
-        buffer_ranks = import_ranks;
-
-        if ( View::rank == 1 )
-            Kokkos::realloc( buffer_values, n_imports );
-        else
-            Kokkos::realloc( buffer_values, n_imports,
-                             source_values.extent( 1 ) );
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "get_source_values" ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
-            KOKKOS_LAMBDA( int i ) {
-                // TODO Using Kokkos::View::access() is a workaround.
-                // We should write specializations for rank-1 and rank-2
-                // objects.
-                for ( int j = 0; j < (int)source_values.extent( 1 ); ++j )
-                    buffer_values.access( i, j ) =
-                        source_values.access( import_source_indices( i ), j );
-            } );
-        Kokkos::fence();
-    }
-
-    template <typename View>
-    static void
-    pushTargetValues( MPI_Comm comm,
-                      Kokkos::View<int *, DeviceType> const &buffer_indices,
-                      Kokkos::View<int *, DeviceType> const &buffer_ranks,
-                      View const &buffer_values, View target_values )
-    {
-        static_assert(
-            View::rank == 1 || View::rank == 2,
-            "pushTargetValues() requires rank-1 or rank-2 view arguments" );
-        ArborX::Details::Distributor<DeviceType> distributor( comm );
-        int const n_imports =
-            distributor.createFromSends( ExecutionSpace{}, buffer_ranks );
-
-        View export_source_values = buffer_values;
-        auto import_source_values =
-            View::rank == 1
-                ? View( "source_values", n_imports )
-                : View( "source_values", n_imports, target_values.extent( 1 ) );
-        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
-            ExecutionSpace{}, distributor, export_source_values,
-            import_source_values );
-
-        Kokkos::View<int *, DeviceType> export_target_indices = buffer_indices;
-        Kokkos::View<int *, DeviceType> import_target_indices( "target_indices",
-                                                               n_imports );
-        ArborX::Details::DistributedTreeImpl<DeviceType>::sendAcrossNetwork(
-            ExecutionSpace{}, distributor, export_target_indices,
-            import_target_indices );
-
-        Kokkos::parallel_for(
-            DTK_MARK_REGION( "set_target_values" ),
-            Kokkos::RangePolicy<ExecutionSpace>( 0, n_imports ),
-            KOKKOS_LAMBDA( int i ) {
-                // TODO Using Kokkos::View::access() is a workaround.
-                // We should write specializations for rank-1 and rank-2
-                // objects.
-                for ( int j = 0; j < (int)target_values.extent( 1 ); ++j )
-                    target_values.access( import_target_indices( i ), j ) =
-                        import_source_values.access( i, j );
-            } );
-        Kokkos::fence();
-    }
-
+    // Fetch the values once. Use CommunicationPlan directly when the same
+    // values need to be fetched several times.
     template <typename View>
     static typename View::non_const_type
     fetch( MPI_Comm comm, Kokkos::View<int const *, DeviceType> ranks,
@@ -157,33 +55,9 @@ struct NearestNeighborOperatorImpl
         static_assert( View::rank == 1 || View::rank == 2,
                        "fetch() requires rank-1 or rank-2 view arguments" );
 
-        DTK_REQUIRE( ranks.extent( 0 ) == indices.extent( 0 ) );
-
-        Kokkos::View<int *, DeviceType> buffer_ranks =
-            Kokkos::create_mirror( DeviceType(), ranks );
-        Kokkos::deep_copy( buffer_ranks, ranks );
-
-        Kokkos::View<int *, DeviceType> buffer_indices =
-            Kokkos::create_mirror( DeviceType(), indices );
-        Kokkos::deep_copy( buffer_indices, indices );
-
-        auto buffer_values =
-            View::rank == 1
-                ? typename View::non_const_type( values.label(), 0 )
-                : typename View::non_const_type( values.label(), 0, 0 );
-
-        pullSourceValues( comm, values, buffer_indices, buffer_ranks,
-                          buffer_values );
-
-        auto values_out =
-            View::rank == 1
-                ? typename View::non_const_type( values.label(),
-                                                 ranks.extent( 0 ) )
-                : typename View::non_const_type(
-                      values.label(), ranks.extent( 0 ), values.extent( 1 ) );
-
-        pushTargetValues( comm, buffer_indices, buffer_ranks, buffer_values,
-                          values_out );
+        CommunicationPlan<DeviceType> plan( comm );
+        plan.createFromRequests( ranks, indices );
+        auto values_out = plan.fetch( values );
 
         DTK_ENSURE( ( values_out.extent( 0 ) == ranks.extent( 0 ) ) &&
                     ( values_out.extent( 1 ) == values.extent( 1 ) ) );
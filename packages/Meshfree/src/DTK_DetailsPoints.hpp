@@ -0,0 +1,72 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DTK_DETAILS_POINTS_HPP
+#define DTK_DETAILS_POINTS_HPP
+
+#include <ArborX.hpp>
+#include <DTK_ConfigDefs.hpp>
+#include <DTK_DBC.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <mpi.h>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+/**
+ * Return the i-th point of \p points as an ArborX::Point. The coordinates of
+ * 2D points are stored in two columns and the points are in the z = 0 plane.
+ */
+template <typename View>
+KOKKOS_INLINE_FUNCTION ArborX::Point makePoint( View const &points, int i )
+{
+    return ArborX::Point{{points( i, 0 ), points( i, 1 ),
+                          points.extent( 1 ) > 2 ? points( i, 2 ) : 0.}};
+}
+
+/**
+ * Build the distributed search tree over \p points. ArborX only indexes 3D
+ * points so 2D points are copied in the z = 0 plane. 3D points are indexed
+ * directly.
+ */
+template <typename DeviceType>
+ArborX::DistributedTree<typename DeviceType::memory_space>
+makeDistributedTree( MPI_Comm comm,
+                     Kokkos::View<Coordinate const **, DeviceType> points )
+{
+    DTK_REQUIRE( ( points.extent( 1 ) == 2 ) || ( points.extent( 1 ) == 3 ) );
+
+    using ExecutionSpace = typename DeviceType::execution_space;
+    using MemorySpace = typename DeviceType::memory_space;
+    if ( points.extent( 1 ) == 3 )
+        return ArborX::DistributedTree<MemorySpace>( comm, ExecutionSpace{},
+                                                     points );
+
+    unsigned int const n_points = points.extent( 0 );
+    Kokkos::View<ArborX::Point *, DeviceType> points_3d( "points_3d",
+                                                         n_points );
+    Kokkos::parallel_for( DTK_MARK_REGION( "convert_2d_points" ),
+                          Kokkos::RangePolicy<ExecutionSpace>( 0, n_points ),
+                          KOKKOS_LAMBDA( int const i ) {
+                              points_3d( i ) = makePoint( points, i );
+                          } );
+    Kokkos::fence();
+
+    return ArborX::DistributedTree<MemorySpace>( comm, ExecutionSpace{},
+                                                 points_3d );
+}
+} // namespace Details
+} // namespace DataTransferKit
+
+#endif
@@ -0,0 +1,144 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DTK_DETAILS_QR_IMPL_HPP
+#define DTK_DETAILS_QR_IMPL_HPP
+
+#include <DTK_DetailsSVDImpl.hpp>
+
+#include <Kokkos_Core.hpp>
+
+#include <cfloat>
+#include <cmath>
+
+namespace DataTransferKit
+{
+namespace Details
+{
+/**
+ * Compute in place the Householder QR factorization of the m x N matrix
+ * @param B. On output, the upper triangle of B contains R and the Householder
+ * vectors are stored below the diagonal with an implicit unit first entry.
+ * The scaling factors of the reflections are stored in @param tau. The
+ * diagonal entries of R smaller than N * DBL_EPSILON times the largest one are
+ * treated as zero. Return the number of such entries, i.e. the rank deficiency
+ * of B. When m < N, the missing diagonal entries count as zero.
+ */
+template <int N, typename Matrix, typename Vector>
+KOKKOS_INLINE_FUNCTION int householderQR( Matrix const &B, Vector const &tau,
+                                          int const m )
+{
+    int const n_reflections = ( m < N ) ? m : N;
+    for ( int j = 0; j < n_reflections; ++j )
+    {
+        double norm = 0.;
+        for ( int i = j; i < m; ++i )
+            norm += B( i, j ) * B( i, j );
+        norm = std::sqrt( norm );
+        if ( norm == 0. )
+        {
+            tau( j ) = 0.;
+            continue;
+        }
+
+        // Choose the sign of the new diagonal entry to avoid cancellation
+        double const alpha = B( j, j );
+        double const beta = ( alpha >= 0. ) ? -norm : norm;
+        tau( j ) = ( beta - alpha ) / beta;
+        double const scaling = 1. / ( alpha - beta );
+        for ( int i = j + 1; i < m; ++i )
+            B( i, j ) *= scaling;
+        B( j, j ) = beta;
+
+        // Apply the reflection to the remaining columns
+        for ( int k = j + 1; k < N; ++k )
+        {
+            double w = B( j, k );
+            for ( int i = j + 1; i < m; ++i )
+                w += B( i, j ) * B( i, k );
+            w *= tau( j );
+            B( j, k ) -= w;
+            for ( int i = j + 1; i < m; ++i )
+                B( i, k ) -= w * B( i, j );
+        }
+    }
+
+    double max_diagonal = 0.;
+    for ( int j = 0; j < n_reflections; ++j )
+        if ( std::abs( B( j, j ) ) > max_diagonal )
+            max_diagonal = std::abs( B( j, j ) );
+    double const threshold = N * DBL_EPSILON * max_diagonal;
+    int rank_deficiency = N - n_reflections;
+    for ( int j = 0; j < n_reflections; ++j )
+        if ( !( std::abs( B( j, j ) ) > threshold ) )
+            ++rank_deficiency;
+
+    return rank_deficiency;
+}
+
+/**
+ * Compute the first row r of the pseudo-inverse of the m x N matrix B whose
+ * QR factorization @param QR was computed by householderQR, i.e. r^T = Q z
+ * where z is the first column of the transpose of the pseudo-inverse of R.
+ * The result is stored in @param r of size m. When B has full column rank, z
+ * is obtained by forward substitution on R^T. Otherwise, R is pseudo-inverted
+ * using pseudoInverse.
+ */
+template <int N, typename Matrix, typename Vector, typename Row>
+KOKKOS_INLINE_FUNCTION void
+firstRowOfPseudoInverse( Matrix const &QR, Vector const &tau, int const m,
+                         int const rank_deficiency, Row const &r )
+{
+    int const n_reflections = ( m < N ) ? m : N;
+    Kokkos::Array<double, N> z;
+    if ( rank_deficiency == 0 )
+    {
+        // Solve R^T z = e_1
+        for ( int i = 0; i < N; ++i )
+        {
+            double tmp = ( i == 0 ) ? 1. : 0.;
+            for ( int j = 0; j < i; ++j )
+                tmp -= QR( j, i ) * z[j];
+            z[i] = tmp / QR( i, i );
+        }
+    }
+    else
+    {
+        using SquareMatrix = Kokkos::Array<Kokkos::Array<double, N>, N>;
+        SquareMatrix R;
+        for ( int i = 0; i < N; ++i )
+            for ( int j = 0; j < N; ++j )
+                R[i][j] = ( ( i <= j ) && ( i < n_reflections ) ) ? QR( i, j )
+                                                                  : 0.;
+        SquareMatrix pseudo_R;
+        pseudoInverse<N>( R, pseudo_R );
+        for ( int j = 0; j < N; ++j )
+            z[j] = pseudo_R[0][j];
+    }
+
+    // r = Q [z, 0]^T where Q = H_0 H_1 ... H_{n_reflections - 1}
+    for ( int i = 0; i < m; ++i )
+        r( i ) = ( i < n_reflections ) ? z[i] : 0.;
+    for ( int j = n_reflections - 1; j >= 0; --j )
+    {
+        double w = r( j );
+        for ( int i = j + 1; i < m; ++i )
+            w += QR( i, j ) * r( i );
+        w *= tau( j );
+        r( j ) -= w;
+        for ( int i = j + 1; i < m; ++i )
+            r( i ) -= w * QR( i, j );
+    }
+}
+} // namespace Details
+} // namespace DataTransferKit
+
+#endif
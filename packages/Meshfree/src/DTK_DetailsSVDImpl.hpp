@@ -32,6 +32,64 @@ KOKKOS_INLINE_FUNCTION int sgn( T x )
     return ( x > 0 ) - ( x < 0 );
 }
 
+using Matrix2x2 = Kokkos::Array<Kokkos::Array<double, 2>, 2>;
+
+KOKKOS_INLINE_FUNCTION void trans_2x2( Matrix2x2 const &A, Matrix2x2 &B )
+{
+    B = {{{{A[0][0], A[1][0]}}, {{A[0][1], A[1][1]}}}};
+}
+
+KOKKOS_INLINE_FUNCTION void mult_2x2( Matrix2x2 const &A, Matrix2x2 const &B,
+                                      Matrix2x2 &C )
+{
+    C = {{{{A[0][0] * B[0][0] + A[0][1] * B[1][0],
+            A[0][0] * B[0][1] + A[0][1] * B[1][1]}},
+          {{A[1][0] * B[0][0] + A[1][1] * B[1][0],
+            A[1][0] * B[0][1] + A[1][1] * B[1][1]}}}};
+}
+
+KOKKOS_INLINE_FUNCTION void svd_2x2( Matrix2x2 const &A, Matrix2x2 &U,
+                                     Matrix2x2 &E, Matrix2x2 &V )
+{
+    Matrix2x2 At, AAt, AtA;
+    trans_2x2( A, At );
+    mult_2x2( A, At, AAt );
+    mult_2x2( At, A, AtA );
+
+    // Find U such that U*A*A’*U’ = diag
+    auto phi = 0.5 * atan2( AAt[0][1] + AAt[1][0], AAt[0][0] - AAt[1][1] );
+    auto cphi = cos( phi );
+    auto sphi = sin( phi );
+
+    U = {{{{cphi, -sphi}}, {{sphi, cphi}}}};
+
+    // Find W such that W’*A’*A*W = diag
+    auto theta = 0.5 * atan2( AtA[0][1] + AtA[1][0], AtA[0][0] - AtA[1][1] );
+    auto ctheta = cos( theta );
+    auto stheta = sin( theta );
+    Matrix2x2 W = {{{{ctheta, -stheta}}, {{stheta, ctheta}}}};
+
+    // Find the singular values from U
+    auto sum = AAt[0][0] + AAt[1][1];
+    auto dif = sqrt( ( AAt[0][0] - AAt[1][1] ) * ( AAt[0][0] - AAt[1][1] ) +
+                     4 * AAt[0][1] * AAt[1][0] );
+    E = {{{{sqrt( 0.5 * ( sum + dif ) ), 0.}},
+          {{0., sqrt( 0.5 * ( sum - dif ) )}}}};
+
+    // Find the correction matrix for the right side (S = U'*A*W)
+    Matrix2x2 Ut, AW, S;
+    mult_2x2( A, W, AW );
+    trans_2x2( U, Ut );
+    mult_2x2( Ut, AW, S );
+
+    // We need copysign here to work with singular systems. Using the regular
+    // sgn will produce a singular C which would lead to singular V.
+    Matrix2x2 C = {{{{std::copysign( 1., S[0][0] ), 0.0}},
+                    {{0.0, std::copysign( 1., S[1][1] )}}}};
+
+    mult_2x2( W, C, V );
+}
+
 // The original version of this functor was taken from Trilinos mini-tensor
 // package. It was adapted to work in a batched mode where matrices are given
 // in a flat 1D array. It also explicitly solves 2x2 singular-value
@@ -50,7 +108,7 @@ struct SVDFunctor
     // &)
     using flat_matrix_type = Kokkos::View<double *, DeviceType>;
     using matrix_type = Kokkos::View<double **, DeviceType>;
-    using matrix_2x2_type = Kokkos::Array<Kokkos::Array<double, 2>, 2>;
+    using matrix_2x2_type = Matrix2x2;
 
   public:
     SVDFunctor( int n, typename flat_matrix_type::const_type As,
@@ -90,12 +148,6 @@ struct SVDFunctor
         }
     }
 
-    KOKKOS_INLINE_FUNCTION
-    void trans_2x2( matrix_2x2_type const &A, matrix_2x2_type &B ) const
-    {
-        B = {{{{A[0][0], A[1][0]}}, {{A[0][1], A[1][1]}}}};
-    }
-
     KOKKOS_INLINE_FUNCTION
     void trans_nxn( typename matrix_type::const_type A, matrix_type &B ) const
     {
@@ -106,61 +158,6 @@ struct SVDFunctor
                 B( i, j ) = A( j, i );
     }
 
-    KOKKOS_INLINE_FUNCTION
-    void mult_2x2( matrix_2x2_type const &A, matrix_2x2_type const &B,
-                   matrix_2x2_type &C ) const
-    {
-        C = {{{{A[0][0] * B[0][0] + A[0][1] * B[1][0],
-                A[0][0] * B[0][1] + A[0][1] * B[1][1]}},
-              {{A[1][0] * B[0][0] + A[1][1] * B[1][0],
-                A[1][0] * B[0][1] + A[1][1] * B[1][1]}}}};
-    }
-
-    KOKKOS_INLINE_FUNCTION
-    void svd_2x2( matrix_2x2_type const &A, matrix_2x2_type &U,
-                  matrix_2x2_type &E, matrix_2x2_type &V ) const
-    {
-        matrix_2x2_type At, AAt, AtA;
-        trans_2x2( A, At );
-        mult_2x2( A, At, AAt );
-        mult_2x2( At, A, AtA );
-
-        // Find U such that U*A*A’*U’ = diag
-        auto phi = 0.5 * atan2( AAt[0][1] + AAt[1][0], AAt[0][0] - AAt[1][1] );
-        auto cphi = cos( phi );
-        auto sphi = sin( phi );
-
-        U = {{{{cphi, -sphi}}, {{sphi, cphi}}}};
-
-        // Find W such that W’*A’*A*W = diag
-        auto theta =
-            0.5 * atan2( AtA[0][1] + AtA[1][0], AtA[0][0] - AtA[1][1] );
-        auto ctheta = cos( theta );
-        auto stheta = sin( theta );
-        matrix_2x2_type W = {{{{ctheta, -stheta}}, {{stheta, ctheta}}}};
-
-        // Find the singular values from U
-        auto sum = AAt[0][0] + AAt[1][1];
-        auto dif = sqrt( ( AAt[0][0] - AAt[1][1] ) * ( AAt[0][0] - AAt[1][1] ) +
-                         4 * AAt[0][1] * AAt[1][0] );
-        E = {{{{sqrt( 0.5 * ( sum + dif ) ), 0.}},
-              {{0., sqrt( 0.5 * ( sum - dif ) )}}}};
-
-        // Find the correction matrix for the right side (S = U'*A*W)
-        matrix_2x2_type Ut, AW, S;
-        mult_2x2( A, W, AW );
-        trans_2x2( U, Ut );
-        mult_2x2( Ut, AW, S );
-
-        // We need copysign here to work with singular systems. Using the
-        // regular sgn will produce a singular C which would lead to singular
-        // V.
-        matrix_2x2_type C = {{{{std::copysign( 1., S[0][0] ), 0.0}},
-                              {{0.0, std::copysign( 1., S[1][1] )}}}};
-
-        mult_2x2( W, C, V );
-    }
-
     KOKKOS_INLINE_FUNCTION
     void argmax_off_diagonal( typename matrix_type::const_type A, int &p,
                               int &q ) const
@@ -308,6 +305,114 @@ struct SVDFunctor
     matrix_type _aux;
 };
 
+/**
+ * Compute the pseudo-inverse of the N x N matrix @param A using a cyclic
+ * two-sided Jacobi singular value decomposition. Unlike SVDFunctor, the size
+ * is known at compile time so the matrices are stored in Kokkos::Array and do
+ * not require any auxiliary allocation. The sweeps stop when the off-diagonal
+ * part is small relative to the norm of A or after @param max_sweeps sweeps.
+ * The singular values smaller than N * DBL_EPSILON times the largest singular
+ * value are treated as zero. Return the number of such singular values, i.e.
+ * the rank deficiency of A.
+ */
+template <int N>
+KOKKOS_INLINE_FUNCTION int
+pseudoInverse( Kokkos::Array<Kokkos::Array<double, N>, N> const &A,
+               Kokkos::Array<Kokkos::Array<double, N>, N> &pseudo_A,
+               int const max_sweeps = 20 )
+{
+    Kokkos::Array<Kokkos::Array<double, N>, N> E = A;
+    Kokkos::Array<Kokkos::Array<double, N>, N> U;
+    Kokkos::Array<Kokkos::Array<double, N>, N> V;
+    double norm = 0.;
+    for ( int i = 0; i < N; ++i )
+        for ( int j = 0; j < N; ++j )
+        {
+            U[i][j] = ( i == j ) ? 1. : 0.;
+            V[i][j] = ( i == j ) ? 1. : 0.;
+            norm += A[i][j] * A[i][j];
+        }
+    double const tol = DBL_EPSILON * DBL_EPSILON * norm;
+
+    for ( int sweep = 0; sweep < max_sweeps; ++sweep )
+    {
+        double off_norm = 0.;
+        for ( int i = 0; i < N; ++i )
+            for ( int j = 0; j < N; ++j )
+                if ( i != j )
+                    off_norm += E[i][j] * E[i][j];
+        if ( off_norm <= tol )
+            break;
+
+        for ( int p = 0; p < N - 1; ++p )
+            for ( int q = p + 1; q < N; ++q )
+            {
+                if ( ( E[p][q] == 0. ) && ( E[q][p] == 0. ) )
+                    continue;
+
+                // Obtain left and right Givens rotations by using 2x2 SVD
+                Matrix2x2 Apq = {
+                    {{{E[p][p], E[p][q]}}, {{E[q][p], E[q][q]}}}};
+                Matrix2x2 L, D, R;
+                svd_2x2( Apq, L, D, R );
+
+                double const cl = L[0][0];
+                double const sl = L[0][1];
+                double const cr = R[0][0];
+                double const sr =
+                    ( sgn( R[0][1] ) == sgn( R[1][0] ) ) ? -R[0][1] : R[0][1];
+
+                // Apply the rotations to E (left and right), U (right), and V
+                // (left). V stores the transpose of the right singular
+                // vectors.
+                for ( int j = 0; j < N; ++j )
+                {
+                    double const epj = E[p][j];
+                    double const eqj = E[q][j];
+                    E[p][j] = cl * epj - sl * eqj;
+                    E[q][j] = sl * epj + cl * eqj;
+                    double const vpj = V[p][j];
+                    double const vqj = V[q][j];
+                    V[p][j] = cr * vpj - sr * vqj;
+                    V[q][j] = sr * vpj + cr * vqj;
+                }
+                for ( int j = 0; j < N; ++j )
+                {
+                    double const ejp = E[j][p];
+                    double const ejq = E[j][q];
+                    E[j][p] = cr * ejp - sr * ejq;
+                    E[j][q] = sr * ejp + cr * ejq;
+                    double const ujp = U[j][p];
+                    double const ujq = U[j][q];
+                    U[j][p] = cl * ujp - sl * ujq;
+                    U[j][q] = sl * ujp + cl * ujq;
+                }
+            }
+    }
+
+    // Compute pseudo-inverse (pseudo_A = V^T pseudoE U^T)
+    double max_singular_value = 0.;
+    for ( int k = 0; k < N; ++k )
+        if ( std::abs( E[k][k] ) > max_singular_value )
+            max_singular_value = std::abs( E[k][k] );
+    double const threshold = N * DBL_EPSILON * max_singular_value;
+    int rank_deficiency = 0;
+    for ( int k = 0; k < N; ++k )
+        if ( !( std::abs( E[k][k] ) > threshold ) )
+            ++rank_deficiency;
+    for ( int i = 0; i < N; ++i )
+        for ( int j = 0; j < N; ++j )
+        {
+            double value = 0.;
+            for ( int k = 0; k < N; ++k )
+                if ( std::abs( E[k][k] ) > threshold )
+                    value += V[k][i] * U[j][k] / E[k][k];
+            pseudo_A[i][j] = value;
+        }
+
+    return rank_deficiency;
+}
+
 } // end namespace Details
 } // end namespace DataTransferKit
 
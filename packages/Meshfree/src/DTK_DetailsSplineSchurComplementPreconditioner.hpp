@@ -0,0 +1,237 @@
+/****************************************************************************
+ * Copyright (c) 2012-2020 by the DataTransferKit authors                   *
+ * All rights reserved.                                                     *
+ *                                                                          *
+ * This file is part of the DataTransferKit library. DataTransferKit is     *
+ * distributed under a BSD 3-clause license. For the licensing terms see    *
+ * the LICENSE file in the top-level directory.                             *
+ *                                                                          *
+ * SPDX-License-Identifier: BSD-3-Clause                                    *
+ ****************************************************************************/
+
+#ifndef DTK_SPLINE_SCHUR_COMPLEMENT_PRECONDITIONER_HPP
+#define DTK_SPLINE_SCHUR_COMPLEMENT_PRECONDITIONER_HPP
+
+#include <DTK_DBC.hpp>
+#include <DTK_DetailsSVDImpl.hpp>
+#include <DTK_Types.h>
+
+#include <Teuchos_Comm.hpp>
+#include <Teuchos_RCP.hpp>
+
+#include <Tpetra_Map.hpp>
+#include <Tpetra_MultiVector.hpp>
+#include <Tpetra_Operator.hpp>
+
+#include <Kokkos_Core.hpp>
+#include <Kokkos_ScatterView.hpp>
+
+#ifdef HAVE_MPI
+#include <Teuchos_DefaultMpiComm.hpp>
+#include <mpi.h>
+#endif
+
+namespace DataTransferKit
+{
+
+/**
+ * Schur complement preconditioner of the spline coupling matrix
+ *
+ *     C = | M   P |
+ *         | P^T 0 |
+ *
+ * where M is the matrix of the radial basis functions and P is the
+ * Vandermonde matrix of the source points. The radial basis functions are
+ * normalized, phi(0) = 1, and have a compact support so M is approximated by
+ * the identity. The preconditioner is the inverse of the block lower
+ * triangular matrix
+ *
+ *     | I   0  |
+ *     | P^T -S |
+ *
+ * where S = P^T P is the Schur complement of the polynomial block, which is
+ * small and dense. Only the polynomial block is preconditioned: the M block is
+ * left untouched. S is pseudo-inverted so that degenerate source points, e.g.
+ * coplanar points, are handled. Its size @p PolySize is the size of the
+ * polynomial basis. As in PolynomialMatrix, the polynomial degrees of freedom
+ * are the last entries of the vectors on the root rank.
+ */
+template <typename Scalar, typename LocalOrdinal, typename GlobalOrdinal,
+          typename Node, int PolySize>
+class SplineSchurComplementPreconditioner
+    : public Tpetra::Operator<Scalar, LocalOrdinal, GlobalOrdinal, Node>
+{
+    using DeviceType = typename Node::device_type;
+    using ExecutionSpace = typename DeviceType::execution_space;
+    using Map = Tpetra::Map<LocalOrdinal, GlobalOrdinal, Node>;
+    using MultiVector =
+        Tpetra::MultiVector<Scalar, LocalOrdinal, GlobalOrdinal, Node>;
+
+  public:
+    /**
+     * Constructor. @param vandermonde contains the local rows of P.
+     */
+    SplineSchurComplementPreconditioner(
+        Kokkos::View<double **, DeviceType> vandermonde,
+        const Teuchos::RCP<const Map> &map )
+        : _vandermonde( vandermonde )
+        , _map( map )
+    {
+        int const local_length = _vandermonde.extent( 0 );
+        int const poly_size = PolySize;
+        DTK_REQUIRE( _vandermonde.extent_int( 1 ) == PolySize );
+
+        // Compute the local contributions to S = P^T P.
+        Kokkos::View<double *, DeviceType> schur( "schur",
+                                                  poly_size * poly_size );
+        {
+            auto scatter_schur =
+                Kokkos::Experimental::create_scatter_view( schur );
+            Kokkos::parallel_for(
+                DTK_MARK_REGION( "spline_preconditioner::schur_complement" ),
+                Kokkos::MDRangePolicy<ExecutionSpace, Kokkos::Rank<3>>(
+                    {0, 0, 0}, {local_length, poly_size, poly_size} ),
+                KOKKOS_LAMBDA( int const i, int const p, int const q ) {
+                    auto access = scatter_schur.access();
+                    access( p * poly_size + q ) +=
+                        vandermonde( i, p ) * vandermonde( i, q );
+                } );
+            Kokkos::Experimental::contribute( schur, scatter_schur );
+        }
+
+        auto schur_host =
+            Kokkos::create_mirror_view_and_copy( Kokkos::HostSpace{}, schur );
+#ifdef HAVE_MPI
+        // Sum the contributions of all the ranks.
+        MPI_Allreduce( MPI_IN_PLACE, schur_host.data(), poly_size * poly_size,
+                       MPI_DOUBLE, MPI_SUM, getRawComm() );
+#endif
+
+        // Pseudo-invert S on the host. The system is consistent when the
+        // source points are degenerate so the pseudo-inverse is enough.
+        Kokkos::Array<Kokkos::Array<double, PolySize>, PolySize> schur_matrix;
+        Kokkos::Array<Kokkos::Array<double, PolySize>, PolySize>
+            pseudo_schur_matrix;
+        for ( int p = 0; p < PolySize; ++p )
+            for ( int q = 0; q < PolySize; ++q )
+                schur_matrix[p][q] = schur_host( p * PolySize + q );
+        Details::pseudoInverse<PolySize>( schur_matrix, pseudo_schur_matrix );
+
+        _pseudo_schur = Kokkos::View<double *, DeviceType>(
+            "pseudo_schur", poly_size * poly_size );
+        auto pseudo_schur_host = Kokkos::create_mirror_view( _pseudo_schur );
+        for ( int p = 0; p < PolySize; ++p )
+            for ( int q = 0; q < PolySize; ++q )
+                pseudo_schur_host( p * PolySize + q ) =
+                    pseudo_schur_matrix[p][q];
+        Kokkos::deep_copy( _pseudo_schur, pseudo_schur_host );
+    }
+
+    Teuchos::RCP<const Map> getDomainMap() const override { return _map; }
+
+    Teuchos::RCP<const Map> getRangeMap() const override { return _map; }
+
+    void
+    apply( const MultiVector &X, MultiVector &Y,
+           Teuchos::ETransp mode = Teuchos::NO_TRANS,
+           Scalar alpha = Teuchos::ScalarTraits<Scalar>::one(),
+           Scalar beta = Teuchos::ScalarTraits<Scalar>::zero() ) const override
+    {
+        DTK_REQUIRE( mode == Teuchos::NO_TRANS );
+        DTK_REQUIRE( _map->isSameAs( *( X.getMap() ) ) );
+        DTK_REQUIRE( _map->isSameAs( *( Y.getMap() ) ) );
+        DTK_REQUIRE( X.getNumVectors() == Y.getNumVectors() );
+
+        int const local_length = _vandermonde.extent( 0 );
+        int const poly_size = PolySize;
+        int const num_vec = X.getNumVectors();
+
+        // To avoid capturing *this
+        auto vandermonde = _vandermonde;
+        auto pseudo_schur = _pseudo_schur;
+
+        Y.scale( beta );
+
+        // The basis components are copied and the local contributions to
+        // P^T X are computed.
+        auto x_view = X.getLocalViewDevice();
+        auto y_view = Y.getLocalViewDevice();
+        Kokkos::View<double **, DeviceType> products( "products", poly_size,
+                                                      num_vec );
+        {
+            auto scatter_products =
+                Kokkos::Experimental::create_scatter_view( products );
+            Kokkos::parallel_for(
+                DTK_MARK_REGION( "spline_preconditioner::apply::basis" ),
+                Kokkos::RangePolicy<ExecutionSpace>( 0, local_length ),
+                KOKKOS_LAMBDA( int const i ) {
+                    auto access = scatter_products.access();
+                    for ( int j = 0; j < num_vec; ++j )
+                    {
+                        double const x_i = x_view( i, j );
+                        y_view( i, j ) += alpha * x_i;
+                        for ( int p = 0; p < poly_size; ++p )
+                            access( p, j ) += vandermonde( i, p ) * x_i;
+                    }
+                } );
+            Kokkos::Experimental::contribute( products, scatter_products );
+        }
+
+        // Reduce the results to the root rank.
+        Kokkos::View<double **, DeviceType> product_sums( "product_sums",
+                                                          poly_size, num_vec );
+#ifdef HAVE_MPI
+        {
+            auto products_host = Kokkos::create_mirror_view_and_copy(
+                Kokkos::HostSpace{}, products );
+            auto product_sums_host = Kokkos::create_mirror_view_and_copy(
+                Kokkos::HostSpace{}, product_sums );
+            MPI_Reduce( products_host.data(), product_sums_host.data(),
+                        poly_size * num_vec, MPI_DOUBLE, MPI_SUM, 0,
+                        getRawComm() );
+            Kokkos::deep_copy( product_sums, product_sums_host );
+        }
+#else
+        product_sums = products;
+#endif
+
+        // Solve for the polynomial components on the root rank:
+        // S Y_poly = P^T X - X_poly
+        if ( 0 == _map->getComm()->getRank() )
+        {
+            int const offset = x_view.extent( 0 ) - poly_size;
+            Kokkos::parallel_for(
+                DTK_MARK_REGION( "spline_preconditioner::apply::polynomial" ),
+                Kokkos::MDRangePolicy<ExecutionSpace, Kokkos::Rank<2>>(
+                    {0, 0}, {poly_size, num_vec} ),
+                KOKKOS_LAMBDA( int const p, int const j ) {
+                    double tmp = 0.;
+                    for ( int q = 0; q < poly_size; ++q )
+                        tmp += pseudo_schur( p * poly_size + q ) *
+                               ( product_sums( q, j ) -
+                                 x_view( offset + q, j ) );
+                    y_view( offset + p, j ) += alpha * tmp;
+                } );
+        }
+    }
+
+    bool hasTransposeApply() const override { return false; }
+
+  private:
+#ifdef HAVE_MPI
+    MPI_Comm getRawComm() const
+    {
+        auto mpi_comm = Teuchos::rcp_dynamic_cast<const Teuchos::MpiComm<int>>(
+            _map->getComm() );
+        return ( *mpi_comm->getRawMpiComm() )();
+    }
+#endif
+
+    Kokkos::View<double **, DeviceType> _vandermonde;
+    Kokkos::View<double *, DeviceType> _pseudo_schur;
+    Teuchos::RCP<const Map> _map;
+};
+
+} // namespace DataTransferKit
+
+#endif
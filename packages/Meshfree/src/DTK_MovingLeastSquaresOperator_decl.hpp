@@ -13,6 +13,7 @@
 #define DTK_MOVING_LEAST_SQUARES_OPERATOR_DECL_HPP
 
 #include <DTK_CompactlySupportedRadialBasisFunctions.hpp>
+#include <DTK_DetailsCommunicationPlan.hpp>
 #include <DTK_MultivariatePolynomialBasis.hpp>
 #include <DTK_PointCloudOperator.hpp>
 
@@ -21,6 +22,18 @@
 namespace DataTransferKit
 {
 
+/**
+ * Method used to solve the local least squares problems. SVD forms the moment
+ * matrix A = P^T phi P and pseudo-inverts it. QR computes the Householder QR
+ * factorization of sqrt(phi) P which does not square the condition number and
+ * only falls back to the SVD when the factorization is rank deficient.
+ */
+enum class MovingLeastSquaresSolver
+{
+    SVD,
+    QR
+};
+
 /**
  * This class implements a function reconstruction technique for arbitrary point
  * cloud based on a moving least square discretization. In this method, support
@@ -47,7 +60,8 @@ class MovingLeastSquaresOperator : public PointCloudOperator<DeviceType>
     MovingLeastSquaresOperator(
         MPI_Comm comm,
         Kokkos::View<Coordinate const **, DeviceType> source_points,
-        Kokkos::View<Coordinate const **, DeviceType> target_points );
+        Kokkos::View<Coordinate const **, DeviceType> target_points,
+        MovingLeastSquaresSolver solver = MovingLeastSquaresSolver::SVD );
 
     void
     apply( Kokkos::View<double const *, DeviceType> source_values,
@@ -57,8 +71,12 @@ class MovingLeastSquaresOperator : public PointCloudOperator<DeviceType>
     MPI_Comm _comm;
     unsigned int const _n_source_points;
     Kokkos::View<int *, DeviceType> _offset;
-    Kokkos::View<int *, DeviceType> _ranks;
-    Kokkos::View<int *, DeviceType> _indices;
+    // Position in the halo of the source points associated to each target
+    // point.
+    Kokkos::View<int *, DeviceType> _neighbor_indices;
+    // Communication plan to retrieve the halo, i.e., the unique source points
+    // associated to the local target points.
+    Details::CommunicationPlan<DeviceType> _plan;
     Kokkos::View<double *, DeviceType> _coeffs;
 };
 
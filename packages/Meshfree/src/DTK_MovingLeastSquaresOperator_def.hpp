@@ -15,7 +15,7 @@
 #include <ArborX.hpp>
 #include <DTK_DBC.hpp>
 #include <DTK_DetailsMovingLeastSquaresOperatorImpl.hpp>
-#include <DTK_DetailsNearestNeighborOperatorImpl.hpp> // fetch
+#include <DTK_DetailsPoints.hpp>
 #include <DTK_DetailsUtils.hpp>
 
 namespace DataTransferKit
@@ -28,24 +28,23 @@ MovingLeastSquaresOperator<DeviceType, CompactlySupportedRadialBasisFunction,
     MovingLeastSquaresOperator(
         MPI_Comm comm,
         Kokkos::View<Coordinate const **, DeviceType> source_points,
-        Kokkos::View<Coordinate const **, DeviceType> target_points )
+        Kokkos::View<Coordinate const **, DeviceType> target_points,
+        MovingLeastSquaresSolver solver )
     : _comm( comm )
     , _n_source_points( source_points.extent( 0 ) )
     , _offset( "offset", 0 )
-    , _ranks( "ranks", 0 )
-    , _indices( "indices", 0 )
+    , _neighbor_indices( "neighbor_indices", 0 )
+    , _plan( comm )
     , _coeffs( "polynomial_coefficients", 0 )
 {
     DTK_REQUIRE( source_points.extent_int( 1 ) ==
                  target_points.extent_int( 1 ) );
-    // FIXME for now let's assume 3D
-    DTK_REQUIRE( source_points.extent_int( 1 ) == 3 );
+    // The dimension of the points is the one of the polynomial basis
+    DTK_REQUIRE( source_points.extent_int( 1 ) == PolynomialBasis::dimension );
 
     using ExecutionSpace = typename DeviceType::execution_space;
-    using MemorySpace = typename DeviceType::memory_space;
     // Build distributed search tree over the source points.
-    ArborX::DistributedTree<MemorySpace> search_tree( _comm, ExecutionSpace{},
-                                                      source_points );
+    auto search_tree = Details::makeDistributedTree( _comm, source_points );
     DTK_CHECK( !search_tree.empty() );
 
     // For each target point, query the n_neighbors points closest to the
@@ -59,63 +58,40 @@ MovingLeastSquaresOperator<DeviceType, CompactlySupportedRadialBasisFunction,
     Kokkos::View<PairIndexRank *, DeviceType> index_rank( "index_rank", 0 );
     search_tree.query( ExecutionSpace{}, queries, index_rank, _offset );
     // Split the pair
-    Details::splitIndexRank( index_rank, _indices, _ranks );
+    Kokkos::View<int *, DeviceType> indices( "indices", 0 );
+    Kokkos::View<int *, DeviceType> ranks( "ranks", 0 );
+    Details::splitIndexRank( index_rank, indices, ranks );
+
+    // Several target points share the same source points. Only retrieve each
+    // of these source points once.
+    auto halo = Details::MovingLeastSquaresOperatorImpl<DeviceType>::buildHalo(
+        ranks, indices );
+    _neighbor_indices = std::get<2>( halo );
+
+    // Build the communication plan once and reuse it in apply().
+    _plan.createFromRequests( std::get<0>( halo ), std::get<1>( halo ) );
 
     // Retrieve the coordinates of all source points that met the predicates.
     // NOTE: This is the last collective.
-    source_points = Details::NearestNeighborOperatorImpl<DeviceType>::fetch(
-        _comm, _ranks, _indices, source_points );
-
-    // Transform source points
-    source_points = Details::MovingLeastSquaresOperatorImpl<
-        DeviceType>::transformSourceCoordinates( source_points, _offset,
-                                                 target_points );
-    target_points = Kokkos::View<Coordinate **, DeviceType>( "empty", 0, 0 );
-
-    // Build P (vandermonde matrix)
-    // P is a single 1D storage for multiple P_i matrices. Each matrix is of
-    // size (#source_points_for_specific_target_point, basis_size)
-    auto p =
-        Details::MovingLeastSquaresOperatorImpl<DeviceType>::computeVandermonde(
-            source_points, PolynomialBasis() );
-
-    // To build the radial basis function, we need to define the radius of the
-    // radial basis function. Since we use kNN, we need to compute the radius.
-    // We only need the coordinates of the source points because of the
-    // transformation of the coordinates.
-    auto radius =
-        Details::MovingLeastSquaresOperatorImpl<DeviceType>::computeRadius(
-            source_points, _offset );
-
-    // Build phi (weight matrix)
-    auto phi =
-        Details::MovingLeastSquaresOperatorImpl<DeviceType>::computeWeights(
-            source_points, radius, CompactlySupportedRadialBasisFunction() );
-
-    // Build A (moment matrix)
-    auto a =
-        Details::MovingLeastSquaresOperatorImpl<DeviceType>::computeMoments(
-            _offset, p, phi );
-
-    // TODO: it is computationally unnecessary to compute the pseudo-inverse as
-    // MxM (U*E^+*V) as it will later be just used to do MxV. We could instead
-    // return the (U,E^+,V) and do the MxV multiplication. But for now, it's OK.
-    auto t = Details::MovingLeastSquaresOperatorImpl<DeviceType>::invertMoments(
-        a, PolynomialBasis::size );
-    auto inv_a = std::get<0>( t );
-
-    // std::get<1>(t) returns the number of undetermined system. However, this
-    // is not enough to know if we will lose order of accuracy. For example, if
-    // all the points are aligned, the system will be underdetermined. However
-    // this is not a problem if we found at least three points since this is
-    // enough to define a quadratic function. Therefore, not only we need to
-    // know the rank deficiency but also the dimension of the problem.
-
-    // NOTE: This assumes that the polynomial basis evaluated at {0,0,0} is
-    // going to be [1, 0, 0, ..., 0]^T.
-    _coeffs = Details::MovingLeastSquaresOperatorImpl<
-        DeviceType>::computePolynomialCoefficients( _offset, inv_a, p, phi,
-                                                    PolynomialBasis::size );
+    auto halo_points = _plan.fetch( source_points );
+
+    // Compute the coefficients. The source points are transformed to the
+    // frame of the target points, and the Vandermonde matrix P, the weights
+    // phi, and the moment matrix A are built and pseudo-inverted target by
+    // target in a single kernel. With the QR solver, A is not formed and
+    // sqrt(phi) P is factorized instead.
+    // NOTE: The rank deficiency of A is not enough to know if we will lose
+    // order of accuracy. For example, if all the points are aligned, the
+    // system will be underdetermined. However this is not a problem if we
+    // found at least three points since this is enough to define a quadratic
+    // function. Therefore, not only we need to know the rank deficiency but
+    // also the dimension of the problem.
+    _coeffs = Details::MovingLeastSquaresOperatorImpl<DeviceType>::
+        computeCoefficients( halo_points, _neighbor_indices, _offset,
+                             target_points,
+                             CompactlySupportedRadialBasisFunction(),
+                             PolynomialBasis(),
+                             solver == MovingLeastSquaresSolver::QR );
 }
 
 template <typename DeviceType, typename CompactlySupportedRadialBasisFunction,
@@ -129,13 +105,13 @@ void MovingLeastSquaresOperator<
     DTK_REQUIRE( source_values.extent( 0 ) == _n_source_points );
     DTK_REQUIRE( target_values.extent( 0 ) == _offset.extent( 0 ) - 1 );
 
-    // Retrieve values for all source points
-    source_values = Details::NearestNeighborOperatorImpl<DeviceType>::fetch(
-        _comm, _ranks, _indices, source_values );
+    // Retrieve values for all the source points in the halo
+    auto halo_values = _plan.fetch( source_values );
 
     // Apply A-1 (P^T phi)
     auto new_target_values = Details::MovingLeastSquaresOperatorImpl<
-        DeviceType>::computeTargetValues( _offset, _coeffs, source_values );
+        DeviceType>::computeTargetValues( _offset, _neighbor_indices, _coeffs,
+                                          halo_values );
 
     Kokkos::deep_copy( target_values, new_target_values );
 }
@@ -147,6 +123,9 @@ void MovingLeastSquaresOperator<
     template class MovingLeastSquaresOperator<typename NODE::device_type>;     \
     template class MovingLeastSquaresOperator<                                 \
         typename NODE::device_type, Wendland<0>,                               \
-        MultivariatePolynomialBasis<Quadratic, 3>>;
+        MultivariatePolynomialBasis<Quadratic, 3>>;                            \
+    template class MovingLeastSquaresOperator<                                 \
+        typename NODE::device_type, Wendland<0>,                               \
+        MultivariatePolynomialBasis<Quadratic, 2>>;
 
 #endif
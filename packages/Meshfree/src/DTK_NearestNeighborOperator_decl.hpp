@@ -12,6 +12,7 @@
 #ifndef DTK_NEAREST_NEIGHBOR_OPERATOR_DECL_HPP
 #define DTK_NEAREST_NEIGHBOR_OPERATOR_DECL_HPP
 
+#include <DTK_DetailsCommunicationPlan.hpp>
 #include <DTK_PointCloudOperator.hpp>
 
 #include <mpi.h>
@@ -40,8 +41,8 @@ class NearestNeighborOperator : public PointCloudOperator<DeviceType>
 
   private:
     MPI_Comm _comm;
-    Kokkos::View<int *, DeviceType> _indices;
-    Kokkos::View<int *, DeviceType> _ranks;
+    Details::CommunicationPlan<DeviceType> _plan;
+    int const _n_target_points;
     int const _size;
 };
 
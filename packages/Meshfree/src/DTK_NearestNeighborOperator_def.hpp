@@ -15,6 +15,7 @@
 #include <ArborX.hpp>
 #include <DTK_DBC.hpp>
 #include <DTK_DetailsNearestNeighborOperatorImpl.hpp>
+#include <DTK_DetailsPoints.hpp>
 #include <DTK_DetailsUtils.hpp>
 
 namespace DataTransferKit
@@ -25,19 +26,20 @@ NearestNeighborOperator<DeviceType>::NearestNeighborOperator(
     MPI_Comm comm, Kokkos::View<Coordinate const **, DeviceType> source_points,
     Kokkos::View<Coordinate const **, DeviceType> target_points )
     : _comm( comm )
-    , _indices( "indices", 0 )
-    , _ranks( "ranks", 0 )
+    , _plan( comm )
+    , _n_target_points( target_points.extent_int( 0 ) )
     , _size( source_points.extent_int( 0 ) )
 {
     // NOTE: instead of checking the pre-condition that there is at least one
     // source point passed to one of the rank, we let the tree handle the
     // communication and just check that the tree is not empty.
 
+    DTK_REQUIRE( source_points.extent_int( 1 ) ==
+                 target_points.extent_int( 1 ) );
+
     using ExecutionSpace = typename DeviceType::execution_space;
-    using MemorySpace = typename DeviceType::memory_space;
     // Build distributed search tree over the source points.
-    ArborX::DistributedTree<MemorySpace> search_tree( _comm, ExecutionSpace{},
-                                                      source_points );
+    auto search_tree = Details::makeDistributedTree( _comm, source_points );
 
     // Tree must have at least one leaf, otherwise it makes little sense to
     // perform the search for nearest neighbors.
@@ -63,11 +65,11 @@ NearestNeighborOperator<DeviceType>::NearestNeighborOperator(
     DTK_ENSURE( ArborX::lastElement( offset ) ==
                 target_points.extent_int( 0 ) );
 
-    // Save results.
+    // Build the communication plan once so that apply() only needs to send
+    // the values.
     // NOTE: we don't bother keeping `offset` around since it is just `[0, 1, 2,
     // ..., n_target_poins]`
-    _indices = indices;
-    _ranks = ranks;
+    _plan.createFromRequests( ranks, indices );
 }
 
 template <typename DeviceType>
@@ -76,11 +78,10 @@ void NearestNeighborOperator<DeviceType>::apply(
     Kokkos::View<double *, DeviceType> target_values ) const
 {
     // Precondition: check that the source and target are properly sized
-    DTK_REQUIRE( _indices.extent( 0 ) == target_values.extent( 0 ) );
+    DTK_REQUIRE( _n_target_points == target_values.extent_int( 0 ) );
     DTK_REQUIRE( _size == source_values.extent_int( 0 ) );
 
-    auto values = Details::NearestNeighborOperatorImpl<DeviceType>::fetch(
-        _comm, _ranks, _indices, source_values );
+    auto values = _plan.fetch( source_values );
 
     Kokkos::deep_copy( target_values, values );
 }
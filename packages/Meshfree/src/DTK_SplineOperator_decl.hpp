@@ -13,12 +13,18 @@
 #define DTK_SPLINE_OPERATOR_DECL_HPP
 
 #include <DTK_CompactlySupportedRadialBasisFunctions.hpp>
+#include <DTK_ConfigDefs.hpp>
 #include <DTK_MultivariatePolynomialBasis.hpp>
 #include <DTK_PointCloudOperator.hpp>
 
+#include <Teuchos_ParameterList.hpp>
 #include <Tpetra_CrsMatrix.hpp>
 
-#include <Thyra_LinearOpBase.hpp>
+#include <Thyra_LinearOpWithSolveBase.hpp>
+
+#ifdef HAVE_DTK_AMESOS2
+#include <Amesos2_Solver_decl.hpp>
+#endif
 
 #include <mpi.h>
 
@@ -62,15 +68,90 @@ class SplineOperator : public PointCloudOperator<DeviceType>
     using polynomial_basis = PolynomialBasis;
     using radial_basis_function = CompactlySupportedRadialBasisFunction;
 
+    /**
+     * Constructor.
+     * @param comm
+     * @param source_points
+     * @param target_points
+     * @param parameters optional parameters of the solve of the coupling
+     * matrix. "Preconditioner" selects the preconditioner built by the
+     * operator: "Schur Complement" (default) for
+     * SplineSchurComplementPreconditioner, which only preconditions the
+     * polynomial block, or "None". The "Stratimikos" sublist is merged into
+     * the default parameters of the solver (Belos Pseudo Block GMRES with a
+     * tolerance of 1e-10), for instance to change the tolerance or the
+     * verbosity or, with "Preconditioner" set to "None", to use a Stratimikos
+     * preconditioner.
+     * "Warm Start" (default true) uses the solution of the previous apply of
+     * each field slot as initial guess. "Recycling" (default false) uses
+     * Belos GCRODR, which reuses a Krylov subspace from one apply to the
+     * next. "Solver" set to "Direct" (default "Iterative") assembles the
+     * coupling matrix, including the polynomial block, and factors it once
+     * with the Amesos2 solver "Direct Solver" (default "KLU2") so that each
+     * apply is a pair of triangular solves. The "Amesos2" sublist is passed
+     * to the solver. The direct solver requires DTK to be built with
+     * Amesos2 and source points that are not coplanar.
+     */
     SplineOperator(
         MPI_Comm comm,
         Kokkos::View<Coordinate const **, DeviceType> source_points,
-        Kokkos::View<Coordinate const **, DeviceType> target_points );
+        Kokkos::View<Coordinate const **, DeviceType> target_points,
+        Teuchos::RCP<Teuchos::ParameterList> const &parameters =
+            Teuchos::null );
 
     void
     apply( Kokkos::View<double const *, DeviceType> source_values,
            Kokkos::View<double *, DeviceType> target_values ) const override;
 
+    /**
+     * Apply the operator to several fields at once. Each column of the values
+     * is a field slot and the coupling system is solved for all the slots
+     * with a single block solve. apply() with one field uses the first slot.
+     */
+    void apply( Kokkos::View<double const **, DeviceType> source_values,
+                Kokkos::View<double **, DeviceType> target_values ) const;
+
+    /**
+     * Return the number of iterations of the last solve of the coupling
+     * system. The count is zero in direct mode.
+     */
+    int getNumIterations() const { return _num_iterations; }
+
+    /**
+     * Return whether the last solve of the coupling system converged. apply()
+     * does not throw when the iterative solver stops before convergence, e.g.
+     * when it reaches the maximum number of iterations, and the target values
+     * are then computed from the last iterate. The direct solve always
+     * converges.
+     */
+    bool hasConverged() const { return _converged; }
+
+    /**
+     * Build the matrix of the radial basis functions centered at the knn
+     * nearest source points of each target point. The CRS arrays and the
+     * column map are built on the device.
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
+    Teuchos::RCP<Operator> buildBasisOperator(
+        Teuchos::RCP<const Map> domain_map, Teuchos::RCP<const Map> range_map,
+        Kokkos::View<Coordinate const **, DeviceType> source_points,
+        Kokkos::View<Coordinate const **, DeviceType> target_points,
+        int const knn );
+
+    /**
+     * Assemble the matrix of the polynomial basis evaluated at the source
+     * points. The columns are the polynomial degrees of freedom, i.e. the
+     * last global ids of @param map, and their rows are empty.
+     *
+     * @note This function should be <b>private</b> but lambda functions can
+     * only be called from a public function in CUDA.
+     */
+    Teuchos::RCP<CrsMatrix> assemblePolynomialOperator(
+        Teuchos::RCP<const Map> map,
+        Kokkos::View<Coordinate const **, DeviceType> points );
+
   private:
     MPI_Comm _comm;
 
@@ -89,30 +170,34 @@ class SplineOperator : public PointCloudOperator<DeviceType>
     // Evaluation matrix basis component.
     Teuchos::RCP<const Operator> N;
 
-    // Coupling matrix
-    Teuchos::RCP<const Thyra::LinearOpBase<SC>> _thyra_operator;
+    // Inverse of the coupling matrix (P + M + P^T)
+    Teuchos::RCP<const Thyra::LinearOpWithSolveBase<SC>> _thyra_C_inverse;
 
-    // Source vector
-    Teuchos::RCP<Vector> _source;
+#ifdef HAVE_DTK_AMESOS2
+    // Factorization of the assembled coupling matrix in direct mode
+    Teuchos::RCP<Amesos2::Solver<CrsMatrix, Vector>> _direct_solver;
+#endif
 
-    // Destination vector
-    Teuchos::RCP<Vector> _destination;
+    // Solutions of the coupling system of the last apply of each field slot
+    mutable Teuchos::RCP<Vector> _solution;
 
-    // Source vector
-    Teuchos::RCP<Thyra::MultiVectorBase<SC>> _thyra_X;
+    // Use the solutions of the last apply as initial guesses
+    bool _warm_start;
 
-    // Destination vector
-    Teuchos::RCP<Thyra::MultiVectorBase<SC>> _thyra_Y;
+    // Number of iterations of the last solve of the coupling system
+    mutable int _num_iterations;
+
+    // Whether the last solve of the coupling system converged
+    mutable bool _converged;
 
     Teuchos::RCP<Operator> buildPolynomialOperator(
         Teuchos::RCP<const Map> domain_map, Teuchos::RCP<const Map> range_map,
         Kokkos::View<Coordinate const **, DeviceType> points );
 
-    Teuchos::RCP<Operator> buildBasisOperator(
-        Teuchos::RCP<const Map> domain_map, Teuchos::RCP<const Map> range_map,
-        Kokkos::View<Coordinate const **, DeviceType> source_points,
-        Kokkos::View<Coordinate const **, DeviceType> target_points,
-        int const knn );
+    // Solve the coupling system for all the field slots of rhs. In iterative
+    // mode, solution contains the initial guess.
+    void solveCouplingSystem( Vector const &rhs,
+                              Teuchos::RCP<Vector> const &solution ) const;
 };
 
 } // end namespace DataTransferKit
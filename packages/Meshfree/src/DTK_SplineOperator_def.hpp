@@ -21,16 +21,24 @@
 #include <DTK_DetailsNearestNeighborOperatorImpl.hpp> // fetch
 #include <DTK_DetailsPolynomialMatrix.hpp>
 #include <DTK_DetailsSplineProlongationOperator.hpp>
+#include <DTK_DetailsSplineSchurComplementPreconditioner.hpp>
 #include <DTK_DetailsUtils.hpp>
 
 #include <Stratimikos_DefaultLinearSolverBuilder.hpp>
 #include <Teuchos_XMLParameterListCoreHelpers.hpp>
 #include <Thyra_DefaultAddedLinearOp.hpp>
 #include <Thyra_DefaultMultipliedLinearOp.hpp>
+#include <Thyra_DefaultPreconditioner.hpp>
 #include <Thyra_DefaultScaledAdjointLinearOp.hpp>
 #include <Thyra_LinearOpWithSolveFactoryHelpers.hpp>
 #include <Thyra_TpetraThyraWrappers.hpp>
 
+#ifdef HAVE_DTK_AMESOS2
+#include <Amesos2.hpp>
+#include <TpetraExt_MatrixMatrix.hpp>
+#include <Tpetra_RowMatrixTransposer.hpp>
+#endif
+
 namespace DataTransferKit
 {
 
@@ -77,13 +85,16 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
     Kokkos::View<int *, DeviceType> ranks( "ranks", 0 );
     Details::splitIndexRank( index_rank, indices, ranks );
 
-    // Retrieve the coordinates of all points that met the predicates.
-    auto source_points_with_halo =
-        Details::NearestNeighborOperatorImpl<DeviceType>::fetch(
-            comm, ranks, indices, source_points );
+    // Retrieve the coordinates of all points that met the predicates. Each
+    // source point is only retrieved once.
+    auto halo = Details::MovingLeastSquaresOperatorImpl<DeviceType>::buildHalo(
+        ranks, indices );
+    auto neighbor_indices = std::get<2>( halo );
+    auto halo_points = Details::NearestNeighborOperatorImpl<DeviceType>::fetch(
+        comm, std::get<0>( halo ), std::get<1>( halo ), source_points );
 
     auto transformed_source_points = Details::MovingLeastSquaresOperatorImpl<
-        DeviceType>::transformSourceCoordinates( source_points_with_halo,
+        DeviceType>::transformSourceCoordinates( halo_points, neighbor_indices,
                                                  offset, target_points );
 
     // To build the radial basis function, we need to define the radius of
@@ -100,38 +111,80 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
             transformed_source_points, radius,
             CompactlySupportedRadialBasisFunction() );
 
-    // Compute some helper arrays
-    int comm_size = teuchos_comm->getSize();
-
-    std::vector<int> cumulative_points_per_process( comm_size + 1 );
-    MPI_Allgather( &num_source_points, 1, MPI_INT,
-                   cumulative_points_per_process.data(), 1, MPI_INT, comm );
-
-    // Exclusive prefix scan
-    int total = 0;
-    for ( int i = 0; i < comm_size; ++i )
-    {
-        int current_value = cumulative_points_per_process[i];
-        cumulative_points_per_process[i] = total;
-        total += current_value;
-    }
-
-    // Build matrix
+    // The global ids of the source points are contiguous on each process.
+    // Compute the global id of the first source point of each process.
+    int const comm_size = teuchos_comm->getSize();
+    Kokkos::View<GO *, DeviceType> first_global_ids( "first_global_ids",
+                                                     comm_size );
+    auto first_global_ids_host = Kokkos::create_mirror_view( first_global_ids );
+    GO const num_local_source_points = num_source_points;
+    MPI_Allgather( &num_local_source_points, 1, MPI_LONG_LONG,
+                   first_global_ids_host.data(), 1, MPI_LONG_LONG, comm );
+    Kokkos::deep_copy( first_global_ids, first_global_ids_host );
+    ExecutionSpace space;
+    ArborX::exclusivePrefixSum( space, first_global_ids );
+
+    // The columns are the unique source points found by the search, i.e. the
+    // halo, so that the position of a source point in the halo is its local
+    // column index.
+    auto halo_ranks = std::get<0>( halo );
+    auto halo_indices = std::get<1>( halo );
+    int const num_columns = halo_ranks.extent( 0 );
+    Kokkos::View<GO *, typename NO::device_type> column_global_ids(
+        "column_global_ids", num_columns );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "compute_column_global_ids" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, num_columns ),
+        KOKKOS_LAMBDA( int const k ) {
+            column_global_ids( k ) =
+                first_global_ids( halo_ranks( k ) ) + halo_indices( k );
+        } );
+    Kokkos::fence();
+    auto col_map = Teuchos::rcp( new Map( Teuchos::OrdinalTraits<GO>::invalid(),
+                                          column_global_ids, 0 /*indexBase*/,
+                                          teuchos_comm ) );
+
+    // Build the local CRS arrays. The rows of the polynomial degrees of
+    // freedom at the end of the range map are empty. The columns of each row
+    // are sorted.
     auto row_map = range_map;
-    auto crs_matrix = Teuchos::rcp( new CrsMatrix( row_map, knn ) );
+    int const num_rows = row_map->getNodeNumElements();
+    DTK_REQUIRE( num_rows >= num_points );
+    int const num_nonzeros = neighbor_indices.extent( 0 );
+    using LocalMatrix = typename CrsMatrix::local_matrix_type;
+    typename LocalMatrix::row_map_type::non_const_type row_pointers(
+        "row_pointers", num_rows + 1 );
+    typename CrsMatrix::local_graph_type::entries_type::non_const_type
+        column_indices( "column_indices", num_nonzeros );
+    typename LocalMatrix::values_type values( "values", num_nonzeros );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "fill_basis_operator" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, num_rows + 1 ),
+        KOKKOS_LAMBDA( int const i ) {
+            row_pointers( i ) = offset( ( i < num_points ) ? i : num_points );
+            if ( i >= num_points )
+                return;
+            int const begin = offset( i );
+            for ( int j = begin; j < offset( i + 1 ); ++j )
+            {
+                LO const column = neighbor_indices( j );
+                SC const value = phi( j );
+                int k = j;
+                for ( ; ( k > begin ) && ( column_indices( k - 1 ) > column );
+                      --k )
+                {
+                    column_indices( k ) = column_indices( k - 1 );
+                    values( k ) = values( k - 1 );
+                }
+                column_indices( k ) = column;
+                values( k ) = value;
+            }
+        } );
+    Kokkos::fence();
 
-    for ( LO i = 0; i < num_points; ++i )
-        for ( int j = offset( i ); j < offset( i + 1 ); ++j )
-        {
-            const auto row_index = row_map->getGlobalElement( i );
-            const auto col_index =
-                cumulative_points_per_process[ranks( j )] + indices( j );
-            const auto value = phi( j );
-
-            crs_matrix->insertGlobalValues( row_index,
-                                            Teuchos::tuple<GO>( col_index ),
-                                            Teuchos::tuple<SC>( value ) );
-        }
+    // Build matrix
+    auto crs_matrix = Teuchos::rcp( new CrsMatrix(
+        row_map, col_map, row_pointers, column_indices, values ) );
 
     crs_matrix->fillComplete( domain_map, range_map );
     DTK_ENSURE( crs_matrix->isFillComplete() );
@@ -159,6 +212,70 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
         new PolynomialMatrix<SC, LO, GO, NO>( v, domain_map, range_map ) );
 }
 
+template <typename DeviceType, typename CompactlySupportedRadialBasisFunction,
+          typename PolynomialBasis>
+Teuchos::RCP<
+    typename SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
+                            PolynomialBasis>::CrsMatrix>
+SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
+               PolynomialBasis>::
+    assemblePolynomialOperator(
+        Teuchos::RCP<const Map> map,
+        Kokkos::View<Coordinate const **, DeviceType> points )
+{
+    DTK_REQUIRE( points.extent( 1 ) == 3 );
+
+    auto v = Details::MovingLeastSquaresOperatorImpl<
+        DeviceType>::computeVandermonde2( points, PolynomialBasis() );
+
+    // The polynomial degrees of freedom are owned by the first process but
+    // every process needs them as columns.
+    int const poly_size = PolynomialBasis::size;
+    GO const first_poly_id = map->getMaxAllGlobalIndex() + 1 - poly_size;
+    Teuchos::Array<GO> poly_ids( poly_size );
+    for ( int p = 0; p < poly_size; ++p )
+        poly_ids[p] = first_poly_id + p;
+    auto col_map = Teuchos::rcp( new Map( Teuchos::OrdinalTraits<GO>::invalid(),
+                                          poly_ids(), 0 /*indexBase*/,
+                                          map->getComm() ) );
+
+    // Build the local CRS arrays. Each row of a point contains the polynomial
+    // basis evaluated at the point.
+    int const num_rows = map->getNodeNumElements();
+    int const num_points = points.extent( 0 );
+    DTK_REQUIRE( num_rows >= num_points );
+    int const num_nonzeros = num_points * poly_size;
+    using LocalMatrix = typename CrsMatrix::local_matrix_type;
+    typename LocalMatrix::row_map_type::non_const_type row_pointers(
+        "row_pointers", num_rows + 1 );
+    typename CrsMatrix::local_graph_type::entries_type::non_const_type
+        column_indices( "column_indices", num_nonzeros );
+    typename LocalMatrix::values_type values( "values", num_nonzeros );
+    Kokkos::parallel_for(
+        DTK_MARK_REGION( "fill_polynomial_operator" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, num_rows + 1 ),
+        KOKKOS_LAMBDA( int const i ) {
+            row_pointers( i ) =
+                poly_size * ( ( i < num_points ) ? i : num_points );
+            if ( i >= num_points )
+                return;
+            for ( int p = 0; p < poly_size; ++p )
+            {
+                column_indices( i * poly_size + p ) = p;
+                values( i * poly_size + p ) = v( i, p );
+            }
+        } );
+    Kokkos::fence();
+
+    auto crs_matrix = Teuchos::rcp( new CrsMatrix(
+        map, col_map, row_pointers, column_indices, values ) );
+
+    crs_matrix->fillComplete( map, map );
+    DTK_ENSURE( crs_matrix->isFillComplete() );
+
+    return crs_matrix;
+}
+
 template <typename DeviceType, typename CompactlySupportedRadialBasisFunction,
           typename PolynomialBasis>
 SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
@@ -166,8 +283,12 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
     SplineOperator(
         MPI_Comm comm,
         Kokkos::View<Coordinate const **, DeviceType> source_points,
-        Kokkos::View<Coordinate const **, DeviceType> target_points )
+        Kokkos::View<Coordinate const **, DeviceType> target_points,
+        Teuchos::RCP<Teuchos::ParameterList> const &parameters )
     : _comm( comm )
+    , _warm_start( true )
+    , _num_iterations( 0 )
+    , _converged( true )
 {
     DTK_REQUIRE( source_points.extent_int( 1 ) ==
                  target_points.extent_int( 1 ) );
@@ -177,6 +298,21 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
 
     constexpr int knn = PolynomialBasis::size;
 
+    std::string solver = "Iterative";
+    std::string preconditioner = "Schur Complement";
+    bool recycling = false;
+    if ( Teuchos::nonnull( parameters ) )
+    {
+        solver = parameters->get<std::string>( "Solver", solver );
+        preconditioner =
+            parameters->get<std::string>( "Preconditioner", preconditioner );
+        _warm_start = parameters->get( "Warm Start", _warm_start );
+        recycling = parameters->get( "Recycling", recycling );
+    }
+    DTK_INSIST( solver == "Iterative" || solver == "Direct" );
+    DTK_INSIST( preconditioner == "Schur Complement" ||
+                preconditioner == "None" );
+
     // Step 0: build source and target maps
     auto teuchos_comm = Teuchos::rcp( new Teuchos::MpiComm<int>( comm ) );
     auto source_map = Teuchos::rcp(
@@ -197,13 +333,53 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
     // matrix
     M = buildBasisOperator( prolongation_map, prolongation_map, source_points,
                             source_points, knn );
-    P = buildPolynomialOperator( prolongation_map, prolongation_map,
-                                 source_points );
+    // The direct solver needs the polynomial block of the coupling matrix to
+    // be assembled.
+    if ( solver == "Direct" )
+        P = assemblePolynomialOperator( prolongation_map, source_points );
+    else
+        P = buildPolynomialOperator( prolongation_map, prolongation_map,
+                                     source_points );
     N = buildBasisOperator( prolongation_map, target_map, source_points,
                             target_points, knn );
     Q = buildPolynomialOperator( prolongation_map, target_map, target_points );
 
-    // Step 3: build Thyra operator: A = (Q + N)*[(P + M + P^T)^-1]*S
+    if ( solver == "Direct" )
+    {
+#ifdef HAVE_DTK_AMESOS2
+        // Step 3: assemble the coupling matrix C = (P + M + P^T) and factor
+        // it once. The factors are reused by every apply().
+        auto crs_M = Teuchos::rcp_dynamic_cast<const CrsMatrix>( M );
+        auto crs_P = Teuchos::rcp_dynamic_cast<const CrsMatrix>( P );
+        Tpetra::RowMatrixTransposer<SC, LO, GO, NO> transposer( crs_P );
+        auto crs_P_T = transposer.createTranspose();
+        auto crs_PpM =
+            Tpetra::MatrixMatrix::add( 1., false, *crs_P, 1., false, *crs_M );
+        Teuchos::RCP<const CrsMatrix> crs_C = Tpetra::MatrixMatrix::add(
+            1., false, *crs_PpM, 1., false, *crs_P_T );
+
+        std::string direct_solver = "KLU2";
+        if ( Teuchos::nonnull( parameters ) )
+            direct_solver =
+                parameters->get<std::string>( "Direct Solver", direct_solver );
+        DTK_INSIST( Amesos2::query( direct_solver ) );
+        _direct_solver =
+            Amesos2::create<CrsMatrix, Vector>( direct_solver, crs_C );
+        if ( Teuchos::nonnull( parameters ) &&
+             parameters->isSublist( "Amesos2" ) )
+            _direct_solver->setParameters(
+                Teuchos::sublist( parameters, "Amesos2" ) );
+        _direct_solver->symbolicFactorization().numericFactorization();
+        DTK_ENSURE( Teuchos::nonnull( _direct_solver ) );
+        return;
+#else
+        throw DataTransferKitException(
+            "The direct solver of the spline operator requires Amesos2" );
+#endif
+    }
+
+    // Step 3: build the inverse of the coupling matrix. The operator is
+    // A = (Q + N)*[(P + M + P^T)^-1]*S and is applied in apply().
     auto thyraWrapper = []( Teuchos::RCP<const Operator> &op ) {
         auto thyra_range_vector_space =
             Thyra::createVectorSpace<SC>( op->getRangeMap() );
@@ -217,11 +393,8 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
         return thyra_op;
     };
 
-    auto thyra_S = thyraWrapper( S );
     auto thyra_M = thyraWrapper( M );
-    auto thyra_N = thyraWrapper( N );
     auto thyra_P = thyraWrapper( P );
-    auto thyra_Q = thyraWrapper( Q );
 
     // Create a transpose of P.
     Teuchos::RCP<const Thyra::LinearOpBase<SC>> thyra_P_T =
@@ -233,7 +406,8 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
     Teuchos::RCP<const Thyra::LinearOpBase<SC>> thyra_C =
         Thyra::add<SC>( thyra_PpM, thyra_P_T );
 
-    // Create parameters for stratimikos to setup the inverse operator.
+    // Create parameters for stratimikos to setup the inverse operator. The
+    // convergence history is only printed on demand.
     auto d_stratimikos_list = Teuchos::parameterList( "Stratimikos" );
     d_stratimikos_list->set( "Linear Solver Type", "Belos" );
     d_stratimikos_list->set( "Preconditioner Type", "None" );
@@ -244,31 +418,54 @@ SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
     auto &solver_types_list = belos_list.sublist( "Solver Types" );
     auto &gmres_list = solver_types_list.sublist( "Pseudo Block GMRES" );
     gmres_list.set( "Convergence Tolerance", 1e-10 );
-    gmres_list.set( "Verbosity",
-                    Belos::Errors + Belos::Warnings + Belos::TimingDetails +
-                        Belos::FinalSummary + Belos::StatusTestDetails );
-    gmres_list.set( "Output Frequency", 1 );
+    gmres_list.set( "Verbosity", Belos::Errors + Belos::Warnings );
+    // GCRODR keeps a recycled Krylov subspace between the solves.
+    auto &gcrodr_list = solver_types_list.sublist( "GCRODR" );
+    gcrodr_list.set( "Convergence Tolerance", 1e-10 );
+    gcrodr_list.set( "Verbosity", Belos::Errors + Belos::Warnings );
+    if ( recycling )
+        belos_list.set( "Solver Type", "GCRODR" );
+    // The initial residual is small when the previous solution is used as
+    // initial guess so the residual is scaled by the right-hand side.
+    if ( _warm_start )
+        for ( auto list : {&gmres_list, &gcrodr_list} )
+        {
+            list->set( "Implicit Residual Scaling", "Norm of RHS" );
+            list->set( "Explicit Residual Scaling", "Norm of RHS" );
+        }
+    if ( Teuchos::nonnull( parameters ) &&
+         parameters->isSublist( "Stratimikos" ) )
+        d_stratimikos_list->setParameters(
+            parameters->sublist( "Stratimikos" ) );
 
     // Create the inverse of the composite operator C.
     Stratimikos::DefaultLinearSolverBuilder builder;
     builder.setParameterList( d_stratimikos_list );
     Teuchos::RCP<Thyra::LinearOpWithSolveFactoryBase<SC>> factory =
         Thyra::createLinearSolveStrategy( builder );
-    Teuchos::RCP<const Thyra::LinearOpBase<SC>> thyra_C_inv =
-        Thyra::inverse<SC>( *factory, thyra_C );
-
-    // Create the composite operator B = (Q + N);
-    Teuchos::RCP<const Thyra::LinearOpBase<SC>> thyra_B =
-        Thyra::add<SC>( thyra_Q, thyra_N );
-
-    // Create the coupling matrix A = (B * C^-1 * S).
-    _thyra_operator = Thyra::multiply<SC>( thyra_B, thyra_C_inv, thyra_S );
-    DTK_ENSURE( Teuchos::nonnull( _thyra_operator ) );
-
-    _source = Teuchos::rcp( new Vector( S->getDomainMap(), 1 ) );
-    _destination = Teuchos::rcp( new Vector( N->getRangeMap(), 1 ) );
-    _thyra_X = Thyra::createMultiVector<SC>( _source );
-    _thyra_Y = Thyra::createMultiVector<SC>( _destination );
+    Teuchos::RCP<Thyra::LinearOpWithSolveBase<SC>> thyra_C_lows =
+        factory->createOp();
+    if ( preconditioner == "Schur Complement" )
+    {
+        // Precondition the polynomial block of C with its Schur complement.
+        auto vandermonde = Details::MovingLeastSquaresOperatorImpl<
+            DeviceType>::computeVandermonde2( source_points,
+                                              PolynomialBasis() );
+        Teuchos::RCP<const Operator> preconditioner_op = Teuchos::rcp(
+            new SplineSchurComplementPreconditioner<SC, LO, GO, NO,
+                                                    PolynomialBasis::size>(
+                vandermonde, prolongation_map ) );
+        Thyra::initializePreconditionedOp<SC>(
+            *factory, thyra_C,
+            Thyra::rightPrec<SC>( thyraWrapper( preconditioner_op ) ),
+            thyra_C_lows.ptr() );
+    }
+    else
+    {
+        Thyra::initializeOp<SC>( *factory, thyra_C, thyra_C_lows.ptr() );
+    }
+    _thyra_C_inverse = thyra_C_lows;
+    DTK_ENSURE( Teuchos::nonnull( _thyra_C_inverse ) );
 }
 
 template <typename DeviceType, typename CompactlySupportedRadialBasisFunction,
@@ -284,21 +481,105 @@ void SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
     DTK_REQUIRE( target_values.extent( 0 ) ==
                  N->getRangeMap()->getNodeNumElements() );
 
-    auto domain_map = S->getDomainMap();
-    auto range_map = N->getRangeMap();
-
-    auto source = Teuchos::rcp( new Vector( domain_map, 1 ) );
-    auto destination = Teuchos::rcp( new Vector( range_map, 1 ) );
-
+    // The values are the first field slot.
+    Kokkos::View<double **, DeviceType> multi_source_values(
+        "source_values", source_values.extent( 0 ), 1 );
     Kokkos::deep_copy(
-        Kokkos::subview( _source->getLocalViewDevice(), Kokkos::ALL, 0 ),
+        Kokkos::subview( multi_source_values, Kokkos::ALL, 0 ),
         source_values );
+    Kokkos::View<double **, DeviceType> multi_target_values(
+        "target_values", target_values.extent( 0 ), 1 );
 
-    _thyra_operator->apply( Thyra::NOTRANS, *_thyra_X, _thyra_Y.ptr(), 1, 0 );
+    apply( multi_source_values, multi_target_values );
 
     Kokkos::deep_copy(
         target_values,
-        Kokkos::subview( _destination->getLocalViewDevice(), Kokkos::ALL, 0 ) );
+        Kokkos::subview( multi_target_values, Kokkos::ALL, 0 ) );
+}
+
+template <typename DeviceType, typename CompactlySupportedRadialBasisFunction,
+          typename PolynomialBasis>
+void SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
+                    PolynomialBasis>::
+    apply( Kokkos::View<double const **, DeviceType> source_values,
+           Kokkos::View<double **, DeviceType> target_values ) const
+{
+    // Precondition: check that the source and the target are properly sized
+    DTK_REQUIRE( source_values.extent( 0 ) ==
+                 S->getDomainMap()->getNodeNumElements() );
+    DTK_REQUIRE( target_values.extent( 0 ) ==
+                 N->getRangeMap()->getNodeNumElements() );
+    DTK_REQUIRE( source_values.extent( 1 ) == target_values.extent( 1 ) );
+
+    int const num_fields = source_values.extent( 1 );
+
+    Vector source( S->getDomainMap(), num_fields );
+    Kokkos::deep_copy( source.getLocalViewDevice(), source_values );
+
+    // Right-hand side of the coupling system
+    Vector rhs( S->getRangeMap(), num_fields );
+    S->apply( source, rhs );
+
+    // The solutions are kept for each field slot. New slots start from zero.
+    if ( _solution.is_null() ||
+         static_cast<int>( _solution->getNumVectors() ) < num_fields )
+    {
+        auto solution =
+            Teuchos::rcp( new Vector( S->getRangeMap(), num_fields ) );
+        if ( Teuchos::nonnull( _solution ) )
+            solution
+                ->subViewNonConst(
+                    Teuchos::Range1D( 0, _solution->getNumVectors() - 1 ) )
+                ->assign( *_solution );
+        _solution = solution;
+    }
+    auto solution =
+        _solution->subViewNonConst( Teuchos::Range1D( 0, num_fields - 1 ) );
+    solveCouplingSystem( rhs, solution );
+
+    // Evaluate (Q + N) at the target points.
+    Vector destination( N->getRangeMap(), num_fields );
+    N->apply( *solution, destination );
+    Q->apply( *solution, destination, Teuchos::NO_TRANS, 1., 1. );
+
+    Kokkos::deep_copy( target_values, destination.getLocalViewDevice() );
+}
+
+template <typename DeviceType, typename CompactlySupportedRadialBasisFunction,
+          typename PolynomialBasis>
+void SplineOperator<DeviceType, CompactlySupportedRadialBasisFunction,
+                    PolynomialBasis>::
+    solveCouplingSystem( Vector const &rhs,
+                         Teuchos::RCP<Vector> const &solution ) const
+{
+    _num_iterations = 0;
+    _converged = true;
+
+#ifdef HAVE_DTK_AMESOS2
+    // Only the triangular solves are left in direct mode.
+    if ( Teuchos::nonnull( _direct_solver ) )
+    {
+        _direct_solver->solve( solution.ptr(), Teuchos::ptrInArg( rhs ) );
+        return;
+    }
+#endif
+
+    if ( !_warm_start )
+        solution->putScalar( 0. );
+
+    // Solve for all the fields at once.
+    auto thyra_rhs = Thyra::createConstMultiVector<SC>(
+        Teuchos::rcpFromRef( rhs ).getConst() );
+    auto thyra_solution = Thyra::createMultiVector<SC>( solution );
+    auto const status = Thyra::solve<SC>( *_thyra_C_inverse, Thyra::NOTRANS,
+                                          *thyra_rhs, thyra_solution.ptr() );
+    // A solve that stops before convergence is not an error, it is reported
+    // by hasConverged().
+    _converged = ( status.solveStatus == Thyra::SOLVE_STATUS_CONVERGED );
+    if ( Teuchos::nonnull( status.extraParameters ) &&
+         status.extraParameters->isParameter( "Belos/Iteration Count" ) )
+        _num_iterations =
+            status.extraParameters->get<int>( "Belos/Iteration Count" );
 }
 
 } // end namespace DataTransferKit
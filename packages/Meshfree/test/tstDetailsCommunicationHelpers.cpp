@@ -10,11 +10,17 @@
  ****************************************************************************/
 
 #include <ArborX.hpp>
+#include <DTK_DetailsCommunicationPlan.hpp>
+#include <DTK_DetailsMovingLeastSquaresOperatorImpl.hpp> // buildHalo
 #include <DTK_DetailsNearestNeighborOperatorImpl.hpp> // fetch
 
 #include <Teuchos_Array.hpp>
 #include <Teuchos_UnitTestHarness.hpp>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 template <
     typename View,
     typename std::enable_if<
@@ -221,6 +227,138 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsNearestNeighborOperatorImpl, fetch,
                                     out );
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsCommunicationPlan, fetch,
+                                   DeviceType )
+{
+    using ExecutionSpace = typename DeviceType::execution_space;
+
+    MPI_Comm comm = MPI_COMM_WORLD;
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+    int comm_size;
+    MPI_Comm_size( comm, &comm_size );
+
+    // make communicaton plan, request twice as many values as there are
+    // processors so that some values are requested several times
+    int const n_requests = 2 * comm_size;
+    Kokkos::View<int *, DeviceType> indices( "indices", n_requests );
+    Kokkos::View<int *, DeviceType> ranks( "ranks", n_requests );
+    Kokkos::parallel_for( Kokkos::RangePolicy<ExecutionSpace>( 0, n_requests ),
+                          KOKKOS_LAMBDA( int i ) {
+                              indices( i ) = ( comm_rank + i ) % comm_size;
+                              ranks( i ) = i % comm_size;
+                          } );
+    Kokkos::fence();
+
+    DataTransferKit::Details::CommunicationPlan<DeviceType> plan( comm );
+    plan.createFromRequests( ranks, indices );
+
+    // The plan is reused for values that change between two calls.
+    for ( int k = 1; k < 3; ++k )
+    {
+        // v(i) <-- k*(comm_rank*comm_size+i) (index i, rank comm_rank)
+        Kokkos::View<int *, DeviceType> v_exp( "v", comm_size );
+        Kokkos::parallel_for(
+            Kokkos::RangePolicy<ExecutionSpace>( 0, comm_size ),
+            KOKKOS_LAMBDA( int i ) {
+                v_exp( i ) = k * ( comm_rank * comm_size + i );
+            } );
+        Kokkos::fence();
+
+        Kokkos::View<int *, DeviceType> v_ref( "v_ref", n_requests );
+        Kokkos::parallel_for(
+            Kokkos::RangePolicy<ExecutionSpace>( 0, n_requests ),
+            KOKKOS_LAMBDA( int i ) {
+                v_ref( i ) = k * ( ranks( i ) * comm_size + indices( i ) );
+            } );
+        Kokkos::fence();
+
+        auto v_imp = plan.fetch( v_exp );
+        TEST_COMPARE_ARRAYS( toArray( v_imp ), toArray( v_ref ) );
+    }
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsMovingLeastSquaresOperatorImpl,
+                                   build_halo, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+    int comm_size;
+    MPI_Comm_size( comm, &comm_size );
+
+    // Every processor owns 4 source points on a line, the source point with
+    // the global id g is the point g % 4 of processor g / 4. The neighbors of
+    // the target point k are the source points k - 1, k, and k + 1, shifted
+    // at the ends of the line. The neighborhoods of consecutive target points
+    // overlap and the first and last ones contain source points owned by the
+    // previous and the next processors.
+    int const n_local_points = 4;
+    int const n_global_points = n_local_points * comm_size;
+    std::vector<int> global_ids;
+    for ( int i = 0; i < n_local_points; ++i )
+    {
+        int const k = comm_rank * n_local_points + i;
+        int const first = std::min( std::max( k - 1, 0 ),
+                                    std::max( n_global_points - 3, 0 ) );
+        for ( int g : {first + 2, first, first + 1} )
+            if ( g < n_global_points )
+                global_ids.push_back( g );
+    }
+    int const n_neighbors = global_ids.size();
+    Kokkos::View<int *, DeviceType> ranks( "ranks", n_neighbors );
+    Kokkos::View<int *, DeviceType> indices( "indices", n_neighbors );
+    auto ranks_host = Kokkos::create_mirror_view( ranks );
+    auto indices_host = Kokkos::create_mirror_view( indices );
+    for ( int j = 0; j < n_neighbors; ++j )
+    {
+        ranks_host( j ) = global_ids[j] / n_local_points;
+        indices_host( j ) = global_ids[j] % n_local_points;
+    }
+    Kokkos::deep_copy( ranks, ranks_host );
+    Kokkos::deep_copy( indices, indices_host );
+
+    auto halo = DataTransferKit::Details::MovingLeastSquaresOperatorImpl<
+        DeviceType>::buildHalo( ranks, indices );
+    auto halo_ranks = toArray( std::get<0>( halo ) );
+    auto halo_indices = toArray( std::get<1>( halo ) );
+    auto neighbor_indices = toArray( std::get<2>( halo ) );
+
+    // Each source point appears once in the halo.
+    std::vector<int> unique_global_ids = global_ids;
+    std::sort( unique_global_ids.begin(), unique_global_ids.end() );
+    unique_global_ids.erase(
+        std::unique( unique_global_ids.begin(), unique_global_ids.end() ),
+        unique_global_ids.end() );
+    int const first_id = std::max( comm_rank * n_local_points - 1, 0 );
+    int const last_id =
+        std::min( ( comm_rank + 1 ) * n_local_points, n_global_points - 1 );
+    TEST_EQUALITY( static_cast<int>( unique_global_ids.size() ),
+                   last_id - first_id + 1 );
+    int const n_halo = halo_ranks.size();
+    TEST_EQUALITY( n_halo, static_cast<int>( unique_global_ids.size() ) );
+    TEST_EQUALITY( static_cast<int>( halo_indices.size() ), n_halo );
+    std::vector<int> halo_global_ids;
+    for ( int h = 0; h < n_halo; ++h )
+        halo_global_ids.push_back( halo_ranks[h] * n_local_points +
+                                   halo_indices[h] );
+    std::sort( halo_global_ids.begin(), halo_global_ids.end() );
+    TEST_COMPARE_ARRAYS( halo_global_ids, unique_global_ids );
+
+    // Each neighbor points to its source point in the halo.
+    TEST_EQUALITY( static_cast<int>( neighbor_indices.size() ), n_neighbors );
+    for ( int j = 0; j < n_neighbors; ++j )
+    {
+        int const h = neighbor_indices[j];
+        TEST_ASSERT( ( h >= 0 ) && ( h < n_halo ) );
+        if ( ( h >= 0 ) && ( h < n_halo ) )
+        {
+            TEST_EQUALITY( halo_ranks[h], ranks_host( j ) );
+            TEST_EQUALITY( halo_indices[h], indices_host( j ) );
+        }
+    }
+}
+
 // Include the test macros.
 #include "DataTransferKit_ETIHelperMacros.h"
 
@@ -230,7 +368,11 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( DetailsNearestNeighborOperatorImpl, fetch,
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT(                                      \
         DetailsDistributedTreeImpl, send_across_network, DeviceType##NODE )    \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsNearestNeighborOperatorImpl,  \
-                                          fetch, DeviceType##NODE )
+                                          fetch, DeviceType##NODE )            \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( DetailsCommunicationPlan, fetch,     \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT(                                      \
+        DetailsMovingLeastSquaresOperatorImpl, build_halo, DeviceType##NODE )
 
 // Demangle the types
 DTK_ETI_MANGLING_TYPEDEFS()
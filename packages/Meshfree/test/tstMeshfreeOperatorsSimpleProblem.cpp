@@ -20,9 +20,11 @@
 
 #include <array>
 #include <cmath>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <random>
+#include <string>
 #include <vector>
 
 int constexpr DIM = 3;
@@ -146,6 +148,390 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MeshfreeOperatorSimpleProblem, corner_cases,
     }
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MeshfreeOperatorSimpleProblem,
+                                   two_dim_quadratic, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    int comm_rank;
+    MPI_Comm_rank( comm, &comm_rank );
+
+    // A quadratic polynomial is reproduced exactly by the moving least squares
+    // with a quadratic basis. The points are stored in two columns.
+    auto f = []( double x, double y ) {
+        return 1. + x + 2. * y + x * x + x * y - y * y;
+    };
+
+    // The source points are on a perturbed 6x6 grid on [0, 1]^2 owned by the
+    // first processor. The perturbation avoids the degenerate sets of
+    // neighbors, e.g. three points on a line, found on a regular grid.
+    int const n = 6;
+    unsigned int const n_source_points = ( comm_rank == 0 ) ? n * n : 0;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> source_points(
+        "source_points", n_source_points, 2 );
+    Kokkos::View<double *, DeviceType> source_values( "source_values",
+                                                      n_source_points );
+    auto source_points_host = Kokkos::create_mirror_view( source_points );
+    auto source_values_host = Kokkos::create_mirror_view( source_values );
+    for ( unsigned int i = 0; i < n_source_points; ++i )
+    {
+        source_points_host( i, 0 ) =
+            ( i % n ) / ( n - 1. ) + 0.05 * std::sin( 3. * i );
+        source_points_host( i, 1 ) =
+            ( i / n ) / ( n - 1. ) + 0.05 * std::cos( 5. * i );
+        source_values_host( i ) =
+            f( source_points_host( i, 0 ), source_points_host( i, 1 ) );
+    }
+    Kokkos::deep_copy( source_points, source_points_host );
+    Kokkos::deep_copy( source_values, source_values_host );
+
+    std::vector<std::array<DataTransferKit::Coordinate, 2>> target_coord = {
+        {{0.45, 0.45}}, {{0.65, 0.25}}};
+    unsigned int const n_target_points = target_coord.size();
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> target_points(
+        "target_points", n_target_points, 2 );
+    auto target_points_host = Kokkos::create_mirror_view( target_points );
+    for ( unsigned int i = 0; i < n_target_points; ++i )
+        for ( unsigned int d = 0; d < 2; ++d )
+            target_points_host( i, d ) = target_coord[i][d];
+    Kokkos::deep_copy( target_points, target_points_host );
+
+    // Both solvers of the local least squares problems reproduce f.
+    for ( auto const solver : {DataTransferKit::MovingLeastSquaresSolver::SVD,
+                               DataTransferKit::MovingLeastSquaresSolver::QR} )
+    {
+        DataTransferKit::MovingLeastSquaresOperator<
+            DeviceType, DataTransferKit::Wendland<0>,
+            DataTransferKit::MultivariatePolynomialBasis<
+                DataTransferKit::Quadratic, 2>>
+            mls( comm, source_points, target_points, solver );
+
+        Kokkos::View<double *, DeviceType> target_values( "target_values",
+                                                          n_target_points );
+        mls.apply( source_values, target_values );
+        auto target_values_host = Kokkos::create_mirror_view( target_values );
+        Kokkos::deep_copy( target_values_host, target_values );
+
+        for ( unsigned int i = 0; i < n_target_points; ++i )
+            TEST_FLOATING_EQUALITY( target_values_host( i ),
+                                    f( target_coord[i][0], target_coord[i][1] ),
+                                    1e-10 );
+    }
+}
+
+// A linear function is reproduced exactly by the spline with a linear basis.
+double linearFunction( double x, double y, double z )
+{
+    return 4. + 2. * x + 3. * y - 2. * z;
+}
+
+double otherLinearFunction( double x, double y, double z )
+{
+    return 2. * linearFunction( x, y, z ) - 1. + z;
+}
+
+// Problem shared by the tests of the solver options of the spline. The source
+// points are on a perturbed 5x5x5 grid on [0, 1]^3 owned by the first
+// processor. The values of the single field sample linearFunction() and the
+// two fields of the multi-field values sample linearFunction() and
+// otherLinearFunction().
+template <typename DeviceType>
+struct SplineProblem
+{
+    explicit SplineProblem( MPI_Comm comm )
+    {
+        int comm_rank;
+        MPI_Comm_rank( comm, &comm_rank );
+
+        int const n = 5;
+        unsigned int const n_source_points =
+            ( comm_rank == 0 ) ? n * n * n : 0;
+        source_points = Kokkos::View<DataTransferKit::Coordinate **,
+                                     DeviceType>( "source_points",
+                                                  n_source_points, DIM );
+        source_values = Kokkos::View<double *, DeviceType>( "source_values",
+                                                            n_source_points );
+        multi_source_values = Kokkos::View<double **, DeviceType>(
+            "multi_source_values", n_source_points, 2 );
+        auto source_points_host = Kokkos::create_mirror_view( source_points );
+        auto source_values_host = Kokkos::create_mirror_view( source_values );
+        auto multi_source_values_host =
+            Kokkos::create_mirror_view( multi_source_values );
+        for ( unsigned int i = 0; i < n_source_points; ++i )
+        {
+            source_points_host( i, 0 ) =
+                ( i % n ) / ( n - 1. ) + 0.05 * std::sin( 3. * i );
+            source_points_host( i, 1 ) =
+                ( ( i / n ) % n ) / ( n - 1. ) + 0.05 * std::cos( 5. * i );
+            source_points_host( i, 2 ) =
+                ( i / ( n * n ) ) / ( n - 1. ) + 0.05 * std::sin( 7. * i );
+            double const x = source_points_host( i, 0 );
+            double const y = source_points_host( i, 1 );
+            double const z = source_points_host( i, 2 );
+            source_values_host( i ) = linearFunction( x, y, z );
+            multi_source_values_host( i, 0 ) = linearFunction( x, y, z );
+            multi_source_values_host( i, 1 ) = otherLinearFunction( x, y, z );
+        }
+        Kokkos::deep_copy( source_points, source_points_host );
+        Kokkos::deep_copy( source_values, source_values_host );
+        Kokkos::deep_copy( multi_source_values, multi_source_values_host );
+
+        unsigned int const n_target_points = target_coord.size();
+        target_points =
+            Kokkos::View<DataTransferKit::Coordinate **, DeviceType>(
+                "target_points", n_target_points, DIM );
+        auto target_points_host = Kokkos::create_mirror_view( target_points );
+        for ( unsigned int i = 0; i < n_target_points; ++i )
+            for ( unsigned int d = 0; d < DIM; ++d )
+                target_points_host( i, d ) = target_coord[i][d];
+        Kokkos::deep_copy( target_points, target_points_host );
+    }
+
+    void checkValues( Kokkos::View<double *, DeviceType> target_values,
+                      double const tolerance, Teuchos::FancyOStream &out,
+                      bool &success ) const
+    {
+        auto target_values_host = Kokkos::create_mirror_view( target_values );
+        Kokkos::deep_copy( target_values_host, target_values );
+        for ( unsigned int i = 0; i < target_coord.size(); ++i )
+            TEST_FLOATING_EQUALITY(
+                target_values_host( i ),
+                linearFunction( target_coord[i][0], target_coord[i][1],
+                                target_coord[i][2] ),
+                tolerance );
+    }
+
+    void checkMultiValues( Kokkos::View<double **, DeviceType> target_values,
+                           double const tolerance, Teuchos::FancyOStream &out,
+                           bool &success ) const
+    {
+        auto target_values_host = Kokkos::create_mirror_view( target_values );
+        Kokkos::deep_copy( target_values_host, target_values );
+        for ( unsigned int i = 0; i < target_coord.size(); ++i )
+        {
+            TEST_FLOATING_EQUALITY(
+                target_values_host( i, 0 ),
+                linearFunction( target_coord[i][0], target_coord[i][1],
+                                target_coord[i][2] ),
+                tolerance );
+            TEST_FLOATING_EQUALITY(
+                target_values_host( i, 1 ),
+                otherLinearFunction( target_coord[i][0], target_coord[i][1],
+                                     target_coord[i][2] ),
+                tolerance );
+        }
+    }
+
+    std::vector<std::array<DataTransferKit::Coordinate, DIM>> const
+        target_coord = {
+            {{0.45, 0.45, 0.45}}, {{0.65, 0.25, 0.8}}, {{0.1, 0.9, 0.3}}};
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> source_points;
+    Kokkos::View<DataTransferKit::Coordinate **, DeviceType> target_points;
+    Kokkos::View<double *, DeviceType> source_values;
+    Kokkos::View<double **, DeviceType> multi_source_values;
+};
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MeshfreeOperatorSimpleProblem,
+                                   spline_preconditioner, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    SplineProblem<DeviceType> const problem( comm );
+    unsigned int const n_target_points = problem.target_coord.size();
+
+    // The spline reproduces the linear function whether the coupling matrix
+    // is preconditioned or not, but the preconditioner must reduce the number
+    // of iterations of the solve.
+    std::map<std::string, int> num_iterations;
+    for ( std::string const preconditioner : {"Schur Complement", "None"} )
+    {
+        auto parameters = Teuchos::parameterList();
+        parameters->set( "Preconditioner", preconditioner );
+        parameters->sublist( "Stratimikos" )
+            .sublist( "Linear Solver Types" )
+            .sublist( "Belos" )
+            .sublist( "Solver Types" )
+            .sublist( "Pseudo Block GMRES" )
+            .set( "Convergence Tolerance", 1e-12 );
+        DataTransferKit::SplineOperator<DeviceType> spline(
+            comm, problem.source_points, problem.target_points, parameters );
+
+        Kokkos::View<double *, DeviceType> target_values( "target_values",
+                                                          n_target_points );
+        spline.apply( problem.source_values, target_values );
+        problem.checkValues( target_values, 1e-9, out, success );
+        TEST_ASSERT( spline.hasConverged() );
+        num_iterations[preconditioner] = spline.getNumIterations();
+    }
+    TEST_COMPARE( num_iterations["Schur Complement"], >, 0 );
+    TEST_COMPARE( num_iterations["Schur Complement"], <,
+                  num_iterations["None"] );
+
+    // A solve that reaches the maximum number of iterations is reported but
+    // apply() does not throw.
+    auto parameters = Teuchos::parameterList();
+    parameters->set( "Preconditioner", "None" );
+    parameters->sublist( "Stratimikos" )
+        .sublist( "Linear Solver Types" )
+        .sublist( "Belos" )
+        .sublist( "Solver Types" )
+        .sublist( "Pseudo Block GMRES" )
+        .set( "Maximum Iterations", 1 );
+    {
+        DataTransferKit::SplineOperator<DeviceType> spline(
+            comm, problem.source_points, problem.target_points, parameters );
+        Kokkos::View<double *, DeviceType> target_values( "target_values",
+                                                          n_target_points );
+        TEST_NOTHROW( spline.apply( problem.source_values, target_values ) );
+        TEST_ASSERT( !spline.hasConverged() );
+        TEST_COMPARE( spline.getNumIterations(), <=, 1 );
+    }
+
+    // Only the built-in preconditioners are accepted.
+    parameters = Teuchos::parameterList();
+    parameters->set( "Preconditioner", "ILU" );
+    TEST_THROW( DataTransferKit::SplineOperator<DeviceType>(
+                    comm, problem.source_points, problem.target_points,
+                    parameters ),
+                DataTransferKit::DataTransferKitException );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MeshfreeOperatorSimpleProblem,
+                                   spline_warm_start_recycling, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    SplineProblem<DeviceType> const problem( comm );
+    unsigned int const n_target_points = problem.target_coord.size();
+
+    // Several fields are transferred at once and the solutions of the field
+    // slots are used as initial guesses by the next applies, with or without
+    // recycling.
+    for ( bool const recycling : {false, true} )
+    {
+        auto parameters = Teuchos::parameterList();
+        parameters->set( "Recycling", recycling );
+        DataTransferKit::SplineOperator<DeviceType> spline(
+            comm, problem.source_points, problem.target_points, parameters );
+
+        Kokkos::View<double **, DeviceType> multi_target_values(
+            "multi_target_values", n_target_points, 2 );
+        std::array<int, 2> num_step_iterations;
+        for ( int step = 0; step < 2; ++step )
+        {
+            spline.apply( problem.multi_source_values, multi_target_values );
+            num_step_iterations[step] = spline.getNumIterations();
+            problem.checkMultiValues( multi_target_values, 1e-8, out,
+                                      success );
+        }
+        // The second apply starts from the solutions of the first one.
+        TEST_COMPARE( num_step_iterations[1], <, num_step_iterations[0] );
+
+        // A single field uses the first slot.
+        Kokkos::View<double *, DeviceType> target_values( "target_values",
+                                                          n_target_points );
+        spline.apply( problem.source_values, target_values );
+        problem.checkValues( target_values, 1e-8, out, success );
+    }
+
+    // Without warm start, the second solve only benefits from the Krylov
+    // subspace recycled by GCRODR.
+    auto parameters = Teuchos::parameterList();
+    parameters->set( "Warm Start", false );
+    parameters->set( "Recycling", true );
+    DataTransferKit::SplineOperator<DeviceType> spline(
+        comm, problem.source_points, problem.target_points, parameters );
+
+    Kokkos::View<double *, DeviceType> target_values( "target_values",
+                                                      n_target_points );
+    std::array<int, 2> num_step_iterations;
+    for ( int step = 0; step < 2; ++step )
+    {
+        spline.apply( problem.source_values, target_values );
+        num_step_iterations[step] = spline.getNumIterations();
+    }
+    TEST_COMPARE( num_step_iterations[0], >, 0 );
+    TEST_COMPARE( num_step_iterations[1], <, num_step_iterations[0] );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MeshfreeOperatorSimpleProblem,
+                                   spline_direct_solver, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    SplineProblem<DeviceType> const problem( comm );
+
+    // The direct solver factors the coupling matrix once and reuses the
+    // factors for each apply. It is not available without Amesos2.
+    auto parameters = Teuchos::parameterList();
+    parameters->set( "Solver", "Direct" );
+#ifdef HAVE_DTK_AMESOS2
+    unsigned int const n_target_points = problem.target_coord.size();
+    DataTransferKit::SplineOperator<DeviceType> direct_spline(
+        comm, problem.source_points, problem.target_points, parameters );
+    Kokkos::View<double **, DeviceType> direct_values( "direct_values",
+                                                       n_target_points, 2 );
+    for ( int step = 0; step < 2; ++step )
+    {
+        direct_spline.apply( problem.multi_source_values, direct_values );
+        problem.checkMultiValues( direct_values, 1e-10, out, success );
+        TEST_ASSERT( direct_spline.hasConverged() );
+        TEST_EQUALITY( direct_spline.getNumIterations(), 0 );
+    }
+
+    // Both solvers solve the same coupling system.
+    auto iterative_parameters = Teuchos::parameterList();
+    iterative_parameters->sublist( "Stratimikos" )
+        .sublist( "Linear Solver Types" )
+        .sublist( "Belos" )
+        .sublist( "Solver Types" )
+        .sublist( "Pseudo Block GMRES" )
+        .set( "Convergence Tolerance", 1e-12 );
+    DataTransferKit::SplineOperator<DeviceType> iterative_spline(
+        comm, problem.source_points, problem.target_points,
+        iterative_parameters );
+    Kokkos::View<double **, DeviceType> iterative_values( "iterative_values",
+                                                          n_target_points, 2 );
+    iterative_spline.apply( problem.multi_source_values, iterative_values );
+
+    auto direct_values_host = Kokkos::create_mirror_view( direct_values );
+    Kokkos::deep_copy( direct_values_host, direct_values );
+    auto iterative_values_host = Kokkos::create_mirror_view( iterative_values );
+    Kokkos::deep_copy( iterative_values_host, iterative_values );
+    for ( unsigned int i = 0; i < n_target_points; ++i )
+        for ( unsigned int j = 0; j < 2; ++j )
+            TEST_FLOATING_EQUALITY( direct_values_host( i, j ),
+                                    iterative_values_host( i, j ), 1e-9 );
+#else
+    TEST_THROW( DataTransferKit::SplineOperator<DeviceType>(
+                    comm, problem.source_points, problem.target_points,
+                    parameters ),
+                DataTransferKit::DataTransferKitException );
+#endif
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MeshfreeOperatorSimpleProblem,
+                                   spline_invalid_solver, DeviceType )
+{
+    MPI_Comm comm = MPI_COMM_WORLD;
+    SplineProblem<DeviceType> const problem( comm );
+
+    // Only the built-in solvers are accepted.
+    auto parameters = Teuchos::parameterList();
+    parameters->set( "Solver", "Cholesky" );
+    TEST_THROW( DataTransferKit::SplineOperator<DeviceType>(
+                    comm, problem.source_points, problem.target_points,
+                    parameters ),
+                DataTransferKit::DataTransferKitException );
+
+#ifdef HAVE_DTK_AMESOS2
+    // The direct solver must be one of the solvers enabled in Amesos2.
+    parameters = Teuchos::parameterList();
+    parameters->set( "Solver", "Direct" );
+    parameters->set( "Direct Solver", "NotASolver" );
+    TEST_THROW( DataTransferKit::SplineOperator<DeviceType>(
+                    comm, problem.source_points, problem.target_points,
+                    parameters ),
+                DataTransferKit::DataTransferKitException );
+#endif
+}
+
 // Include the test macros.
 #include "DataTransferKit_ETIHelperMacros.h"
 
@@ -164,7 +550,21 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MeshfreeOperatorSimpleProblem, corner_cases,
         DataTransferKit::SplineOperator<DeviceType##NODE, RadialBasisFunction, \
                                         PolynomialBasis>;                      \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MeshfreeOperatorSimpleProblem,       \
-                                          corner_cases, Spline##NODE )
+                                          corner_cases, Spline##NODE )         \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT(                                      \
+        MeshfreeOperatorSimpleProblem, two_dim_quadratic, DeviceType##NODE )   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MeshfreeOperatorSimpleProblem,       \
+                                          spline_preconditioner,               \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MeshfreeOperatorSimpleProblem,       \
+                                          spline_warm_start_recycling,         \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MeshfreeOperatorSimpleProblem,       \
+                                          spline_direct_solver,                \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MeshfreeOperatorSimpleProblem,       \
+                                          spline_invalid_solver,               \
+                                          DeviceType##NODE )
 
 // Demangle the types
 DTK_ETI_MANGLING_TYPEDEFS()
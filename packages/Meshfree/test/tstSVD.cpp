@@ -12,12 +12,14 @@
 #include <Teuchos_UnitTestHarness.hpp>
 
 #include <DTK_DBC.hpp>
+#include <DTK_DetailsQRImpl.hpp>
 #include <DTK_DetailsSVDImpl.hpp>
 
 #include <Kokkos_View.hpp>
 
 #include <random>
 #include <set>
+#include <vector>
 
 template <typename DeviceType>
 void check_result( Kokkos::View<double *, DeviceType> matrices,
@@ -71,8 +73,7 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SVD, full_rank, DeviceType )
     int const size = n_matrices * matrix_size * matrix_size;
     Kokkos::View<double *, DeviceType> matrices( "matrices", size );
     Kokkos::View<double *, DeviceType> inv_matrices( "inv_matrices", size );
-    // For magic number 3, see comment in
-    // DTK_DetailsMovingLeastSquaresOperatorImpl.hpp
+    // The auxiliary space stores the matrices E, U, and V of each matrix
     Kokkos::View<double **, DeviceType> aux( "aux", matrix_size,
                                              3 * n_matrices * matrix_size );
 
@@ -106,8 +107,7 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SVD, rank_deficient, DeviceType )
     int const size = n_matrices * matrix_size * matrix_size;
     Kokkos::View<double *, DeviceType> matrices( "matrices", size );
     Kokkos::View<double *, DeviceType> inv_matrices( "inv_matrices", size );
-    // For magic number 3, see comment in
-    // DTK_DetailsMovingLeastSquaresOperatorImpl.hpp
+    // The auxiliary space stores the matrices E, U, and V of each matrix
     Kokkos::View<double **, DeviceType> aux( "aux", matrix_size,
                                              3 * n_matrices * matrix_size );
 
@@ -149,6 +149,142 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SVD, rank_deficient, DeviceType )
                   rank_deficiency, out, success );
 }
 
+// Compute the pseudo-inverses of the matrices using the compile-time sized
+// SVD and return the number of rank deficient matrices.
+template <int N, typename DeviceType>
+int computePseudoInverses( Kokkos::View<double *, DeviceType> matrices,
+                           Kokkos::View<double *, DeviceType> inv_matrices )
+{
+    int const n_matrices = matrices.extent( 0 ) / ( N * N );
+    int n_underdetermined = 0;
+    using ExecutionSpace = typename DeviceType::execution_space;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "compute_pseudo_inverse" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, n_matrices ),
+        KOKKOS_LAMBDA( int const m, int &local_underdetermined ) {
+            Kokkos::Array<Kokkos::Array<double, N>, N> a;
+            for ( int i = 0; i < N; ++i )
+                for ( int j = 0; j < N; ++j )
+                    a[i][j] = matrices( m * N * N + i * N + j );
+            Kokkos::Array<Kokkos::Array<double, N>, N> inv_a;
+            if ( DataTransferKit::Details::pseudoInverse<N>( a, inv_a ) > 0 )
+                ++local_underdetermined;
+            for ( int i = 0; i < N; ++i )
+                for ( int j = 0; j < N; ++j )
+                    inv_matrices( m * N * N + i * N + j ) = inv_a[i][j];
+        },
+        n_underdetermined );
+
+    return n_underdetermined;
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SVD, compile_time_size, DeviceType )
+{
+    // Use the size of the quadratic basis in 3D
+    int constexpr matrix_size = 10;
+    int const n_matrices = 10;
+    int const size = n_matrices * matrix_size * matrix_size;
+    Kokkos::View<double *, DeviceType> matrices( "matrices", size );
+    Kokkos::View<double *, DeviceType> inv_matrices( "inv_matrices", size );
+
+    // Fill the matrices
+    std::set<int> rank_deficiency;
+    auto matrices_host = Kokkos::create_mirror_view( matrices );
+    std::default_random_engine random_engine;
+    std::uniform_real_distribution<double> distribution( -1000, 1000 );
+    for ( int i = 0; i < size; ++i )
+        matrices_host( i ) = distribution( random_engine );
+    Kokkos::deep_copy( matrices, matrices_host );
+
+    int n_underdetermined =
+        computePseudoInverses<matrix_size>( matrices, inv_matrices );
+    TEST_EQUALITY( n_underdetermined, 0 );
+    check_result( matrices, inv_matrices, n_matrices, matrix_size,
+                  rank_deficiency, out, success );
+
+    // Set the fourth column to zero
+    rank_deficiency.insert( 3 );
+    for ( int m = 0; m < n_matrices; ++m )
+        for ( int i = 0; i < matrix_size; ++i )
+            matrices_host( m * matrix_size * matrix_size + i * matrix_size +
+                           3 ) = 0.;
+    Kokkos::deep_copy( matrices, matrices_host );
+
+    n_underdetermined =
+        computePseudoInverses<matrix_size>( matrices, inv_matrices );
+    TEST_EQUALITY( n_underdetermined, n_matrices );
+    check_result( matrices, inv_matrices, n_matrices, matrix_size,
+                  rank_deficiency, out, success );
+}
+
+// Compute the first row of the pseudo-inverse of the m x N matrix b (row
+// major, m <= N) using the QR factorization and compare it to the first row of
+// the pseudo-inverse of b padded with zero rows computed by pseudoInverse.
+template <int N, typename DeviceType>
+void checkFirstRowOfPseudoInverse( std::vector<double> const &b, int const m,
+                                   int const expected_rank_deficiency,
+                                   Teuchos::FancyOStream &out, bool &success )
+{
+    Kokkos::View<double **, DeviceType> qr( "qr", m, N );
+    auto qr_host = Kokkos::create_mirror_view( qr );
+    for ( int i = 0; i < m; ++i )
+        for ( int j = 0; j < N; ++j )
+            qr_host( i, j ) = b[i * N + j];
+    Kokkos::deep_copy( qr, qr_host );
+    Kokkos::View<double *, DeviceType> tau( "tau", N );
+    Kokkos::View<double *, DeviceType> r( "r", m );
+    int rank_deficiency = 0;
+    using ExecutionSpace = typename DeviceType::execution_space;
+    Kokkos::parallel_reduce(
+        DTK_MARK_REGION( "compute_first_row_of_pseudo_inverse" ),
+        Kokkos::RangePolicy<ExecutionSpace>( 0, 1 ),
+        KOKKOS_LAMBDA( int const, int &local_rank_deficiency ) {
+            local_rank_deficiency =
+                DataTransferKit::Details::householderQR<N>( qr, tau, m );
+            DataTransferKit::Details::firstRowOfPseudoInverse<N>(
+                qr, tau, m, local_rank_deficiency, r );
+        },
+        rank_deficiency );
+    TEST_EQUALITY( rank_deficiency, expected_rank_deficiency );
+
+    Kokkos::Array<Kokkos::Array<double, N>, N> padded_b;
+    for ( int i = 0; i < N; ++i )
+        for ( int j = 0; j < N; ++j )
+            padded_b[i][j] = ( i < m ) ? b[i * N + j] : 0.;
+    Kokkos::Array<Kokkos::Array<double, N>, N> pseudo_b;
+    DataTransferKit::Details::pseudoInverse<N>( padded_b, pseudo_b );
+
+    auto r_host = Kokkos::create_mirror_view( r );
+    Kokkos::deep_copy( r_host, r );
+    double const relative_tolerance = 1e-12;
+    for ( int i = 0; i < m; ++i )
+        TEST_FLOATING_EQUALITY( r_host( i ) + 1., pseudo_b[0][i] + 1.,
+                                relative_tolerance );
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SVD, qr_pseudo_inverse, DeviceType )
+{
+    // Use the size of the linear basis in 3D: the rows are (1, x, y, z)
+    int constexpr matrix_size = 4;
+
+    // Full rank
+    std::vector<double> b = {1., 0.,  0.,   0.,  1., 1., 0.5, 0.,
+                             1., 0.2, 1.,   0.,  1., 0., 0.3, 1.5};
+    checkFirstRowOfPseudoInverse<matrix_size, DeviceType>( b, 4, 0, out,
+                                                           success );
+
+    // Collinear points along the x axis
+    b = {1., -1.5, 0., 0., 1., -0.5, 0., 0.,
+         1., 0.25, 0., 0., 1., 2.,   0., 0.};
+    checkFirstRowOfPseudoInverse<matrix_size, DeviceType>( b, 4, 2, out,
+                                                           success );
+
+    // Fewer points than basis functions
+    b = {1., 0.5, -1., 2., 1., 1.5, 0.25, -0.5};
+    checkFirstRowOfPseudoInverse<matrix_size, DeviceType>( b, 2, 2, out,
+                                                           success );
+}
+
 // Include the test macros.
 #include "DataTransferKit_ETIHelperMacros.h"
 
@@ -157,6 +293,10 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( SVD, rank_deficient, DeviceType )
     using DeviceType##NODE = typename NODE::device_type;                       \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( SVD, full_rank, DeviceType##NODE )   \
     TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( SVD, rank_deficient,                 \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( SVD, compile_time_size,              \
+                                          DeviceType##NODE )                   \
+    TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( SVD, qr_pseudo_inverse,              \
                                           DeviceType##NODE )
 // Demangle the types
 DTK_ETI_MANGLING_TYPEDEFS()